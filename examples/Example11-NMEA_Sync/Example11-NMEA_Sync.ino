@@ -0,0 +1,76 @@
+/*
+  Set the RV-8803 Real Time Clock from the NMEA sentences of any GNSS module
+  By: SparkFun Electronics
+  Date: 10/19/2026
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+
+  Feel like supporting our work? Buy a board from SparkFun!
+  https://www.sparkfun.com/products/16281
+
+  This example shows how to set the RTC without a GNSS library. RV8803_NMEA picks the UTC time and date out of
+  the RMC or ZDA sentences as they stream in, and checks their checksums. setTimeFromNMEA() converts the time
+  to the time zone stored in the RTC.
+
+  NMEA sentences arrive a few hundred milliseconds after the second they describe. If you connect the GNSS
+  PPS (pulse per second / timing pulse) pin, the RTC is started exactly on the next pulse instead.
+
+  Hardware Connections:
+    Plug the RTC into the Qwiic port on your microcontroller or on your Qwiic shield/adapter.
+    Connect the GNSS TX pin to the RX pin of Serial1. Most modules default to 9600 baud.
+    Optionally connect the GNSS PPS pin to ppsPin below.
+    Open the serial monitor at 115200 baud
+*/
+
+#define myTimeZone -24   // Quarter hours from UTC. -24 is Mountain Time with Daylight Saving, 6 hours behind UTC
+
+#define ppsPin RV8803_NO_PIN // Change this to the pin the PPS signal is connected to, e.g. 2
+
+#include <SparkFun_RV8803.h> //Get the library here:http://librarymanager/All#SparkFun_RV-8803
+
+RV8803 rtc;
+RV8803_NMEA nmea;
+
+bool timeSet = false;
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println(F("Set RTC from NMEA"));
+
+  Serial1.begin(9600);
+
+  Wire.begin();
+  if (rtc.begin() == false)
+  {
+    Serial.println(F("Something went wrong, check wiring"));
+    while (1);
+  }
+  Serial.println(F("RTC online!"));
+
+  if (ppsPin != RV8803_NO_PIN)
+    pinMode(ppsPin, INPUT);
+
+  rtc.setTimeZoneQuarterHours(myTimeZone);
+}
+
+void loop()
+{
+  if (nmea.update(Serial1) && (timeSet == false)) //Wait for a valid RMC or ZDA sentence
+  {
+    if (rtc.setTimeFromNMEA(nmea, ppsPin))
+    {
+      Serial.println(F("RTC set from NMEA"));
+      timeSet = true;
+    }
+    else
+      Serial.println(F("Could not set the RTC, will try again"));
+  }
+
+  static unsigned long lastPrint = 0;
+  if (timeSet && (millis() - lastPrint > 1000))
+  {
+    lastPrint = millis();
+    if (rtc.updateTime())
+      Serial.println(rtc.formatTime8601TZ());
+  }
+}
@@ -0,0 +1,74 @@
+/*
+  Recording every I2C transaction the RV-8803 library makes
+  By: SparkFun Electronics
+  Date: 10/19/2026
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+
+  Feel like supporting our work? Buy a board from SparkFun!
+  https://www.sparkfun.com/products/16281
+
+  This example shows how to give the library a trace buffer. Every read and write is logged with its register,
+  data, result and a micros() timestamp. When the buffer fills up the oldest records are dropped.
+  Send 'd' in the serial monitor to dump the trace as hex (use exportTrace(Serial) directly for raw binary).
+
+  Hardware Connections:
+    Plug the RTC into the Qwiic port on your microcontroller or on your Qwiic shield/adapter.
+    If you are using an adapter cable, here is the wire color scheme: 
+    Black=GND, Red=3.3V, Blue=SDA, Yellow=SCL
+    Open the serial monitor at 115200 baud
+*/
+
+#include <SparkFun_RV8803.h> //Get the library here:http://librarymanager/All#SparkFun_RV-8803
+
+RV8803 rtc;
+
+uint8_t traceBuffer[256];
+
+//Prints each byte it is given as two hex digits
+class HexPrinter : public Print
+{
+public:
+  size_t write(uint8_t value)
+  {
+    if (value < 0x10)
+      Serial.print('0');
+    Serial.print(value, HEX);
+    Serial.print(' ');
+    return 1;
+  }
+};
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Bus Trace Example");
+
+  Wire.begin();
+  rtc.setTraceBuffer(traceBuffer, sizeof(traceBuffer));
+
+  if (rtc.begin() == false)
+  {
+    Serial.println("Something went wrong, check wiring");
+    while (1);
+  }
+  Serial.println("RTC online!");
+}
+
+void loop()
+{
+  if (rtc.updateTime())
+    Serial.println(rtc.formatTime8601());
+
+  if (Serial.available() && (Serial.read() == 'd'))
+  {
+    Serial.print(rtc.getTraceRecordCount());
+    Serial.print(" records, ");
+    Serial.print(rtc.getTraceDroppedCount());
+    Serial.println(" dropped");
+    HexPrinter hex;
+    rtc.exportTrace(hex);
+    Serial.println();
+  }
+
+  delay(1000);
+}
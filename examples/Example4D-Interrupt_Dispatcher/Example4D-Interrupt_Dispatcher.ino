@@ -0,0 +1,66 @@
+/*
+  Handling several interrupt sources on the RV-8803 Real Time Clock with one flag read
+  By: SparkFun Electronics
+  Date: 10/19/2026
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+
+  Feel like supporting our work? Buy a board from SparkFun!
+  https://www.sparkfun.com/products/16281
+
+  This example shows how to attach a handler to each interrupt flag and service them all together.
+  serviceInterrupts() reads the flag register once, clears every flag that has a handler in a single write
+  and then calls the handlers. Here we get a periodic update every second and the countdown timer every 5 seconds.
+
+  Hardware Connections:
+    Plug the RTC into the Qwiic port on your microcontroller or on your Qwiic shield/adapter.
+    If you are using an adapter cable, here is the wire color scheme: 
+    Black=GND, Red=3.3V, Blue=SDA, Yellow=SCL
+    Open the serial monitor at 115200 baud
+*/
+
+#include <SparkFun_RV8803.h> //Get the library here:http://librarymanager/All#SparkFun_RV-8803
+
+RV8803 rtc;
+
+void updateHandler()
+{
+  Serial.println("Tick");
+}
+
+void timerHandler()
+{
+  Serial.println("Countdown timer expired");
+}
+
+void setup()
+{
+  Wire.begin();
+
+  Serial.begin(115200);
+  Serial.println("Interrupt Dispatcher Example");
+
+  if (rtc.begin() == false)
+  {
+    Serial.println("Device not found. Please check wiring. Freezing.");
+    while(1);
+  }
+  Serial.println("RTC online!");
+
+  rtc.disableAllInterrupts();
+  rtc.clearAllInterruptFlags();//Clear all flags in case any interrupts have occurred.
+
+  rtc.setPeriodicTimeUpdateFrequency(TIME_UPDATE_1_SECOND);
+  rtc.setCountdownTimerFrequency(COUNTDOWN_TIMER_FREQUENCY_1_HZ);
+  rtc.setCountdownTimerClockTicks(5);
+  rtc.enableHardwareInterrupt(UPDATE_INTERRUPT);
+  rtc.enableHardwareInterrupt(TIMER_INTERRUPT);
+  rtc.setCountdownTimerEnable(COUNTDOWN_TIMER_ON);
+
+  rtc.attachInterruptHandler(FLAG_UPDATE, updateHandler);
+  rtc.attachInterruptHandler(FLAG_TIMER, timerHandler);
+}
+
+void loop()
+{
+  rtc.serviceInterrupts(); //One read of the flag register, however many sources are pending
+}
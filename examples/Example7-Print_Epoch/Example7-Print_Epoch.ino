@@ -45,13 +45,11 @@ void loop()
     String currentTime = rtc.stringTime8601();
     Serial.println(currentTime);
 
-    // Get the Epoch time - starting from Jan 1st 2000
-    unsigned long epochTime = rtc.getEpoch();
-
     // Get the UNIX Epoch time
-    // Unix time starts at Jan 1st 1970 UTC (not Jan 1st 2000)
+    // Unix time starts at Jan 1st 1970 UTC. getEpoch(true) counts from then on every platform.
+    // getEpoch() counts from the platform's own time_t epoch: Jan 1st 2000 on AVR, Jan 1st 1970 elsewhere
     // https://www.unixtimestamp.com/
-    //unsigned long epochTime = rtc.getEpoch(true); // <- Set the use1970sEpoch parameter to true (default is false)
+    unsigned long epochTime = rtc.getEpoch(true); // <- Set the use1970sEpoch parameter to true (default is false)
     
     Serial.println(epochTime);
   }
@@ -22,44 +22,81 @@ Distributed as-is; no warranty is given.
 //
 //****************************************************************************//
 
-// Parse the __DATE__ predefined macro to generate date defaults:
-// __Date__ Format: MMM DD YYYY (First D may be a space if <10)
-// <MONTH>
-#define BUILD_MONTH_JAN ((__DATE__[0] == 'J') && (__DATE__[1] == 'a')) ? 1 : 0
-#define BUILD_MONTH_FEB (__DATE__[0] == 'F') ? 2 : 0
-#define BUILD_MONTH_MAR ((__DATE__[0] == 'M') && (__DATE__[1] == 'a') && (__DATE__[2] == 'r')) ? 3 : 0
-#define BUILD_MONTH_APR ((__DATE__[0] == 'A') && (__DATE__[1] == 'p')) ? 4 : 0
-#define BUILD_MONTH_MAY ((__DATE__[0] == 'M') && (__DATE__[1] == 'a') && (__DATE__[2] == 'y')) ? 5 : 0
-#define BUILD_MONTH_JUN ((__DATE__[0] == 'J') && (__DATE__[1] == 'u') && (__DATE__[2] == 'n')) ? 6 : 0
-#define BUILD_MONTH_JUL ((__DATE__[0] == 'J') && (__DATE__[1] == 'u') && (__DATE__[2] == 'l')) ? 7 : 0
-#define BUILD_MONTH_AUG ((__DATE__[0] == 'A') && (__DATE__[1] == 'u')) ? 8 : 0
-#define BUILD_MONTH_SEP (__DATE__[0] == 'S') ? 9 : 0
-#define BUILD_MONTH_OCT (__DATE__[0] == 'O') ? 10 : 0
-#define BUILD_MONTH_NOV (__DATE__[0] == 'N') ? 11 : 0
-#define BUILD_MONTH_DEC (__DATE__[0] == 'D') ? 12 : 0
-#define BUILD_MONTH BUILD_MONTH_JAN | BUILD_MONTH_FEB | BUILD_MONTH_MAR | BUILD_MONTH_APR | BUILD_MONTH_MAY | BUILD_MONTH_JUN | BUILD_MONTH_JUL | BUILD_MONTH_AUG | BUILD_MONTH_SEP | BUILD_MONTH_OCT | BUILD_MONTH_NOV | BUILD_MONTH_DEC
-// <DATE>
-#define BUILD_DATE_0 ((__DATE__[4] == ' ') ? 0 : (__DATE__[4] - 0x30))
-#define BUILD_DATE_1 (__DATE__[5] - 0x30)
-#define BUILD_DATE ((BUILD_DATE_0 * 10) + BUILD_DATE_1)
-// <YEAR>
-#define BUILD_YEAR (((__DATE__[7] - 0x30) * 1000) + ((__DATE__[8] - 0x30) * 100) + ((__DATE__[9] - 0x30) * 10) + ((__DATE__[10] - 0x30) * 1))
-
-// Parse the __TIME__ predefined macro to generate time defaults:
-// __TIME__ Format: HH:MM:SS (First number of each is padded by 0 if <10)
-// <HOUR>
-#define BUILD_HOUR_0 ((__TIME__[0] == ' ') ? 0 : (__TIME__[0] - 0x30))
-#define BUILD_HOUR_1 (__TIME__[1] - 0x30)
-#define BUILD_HOUR ((BUILD_HOUR_0 * 10) + BUILD_HOUR_1)
-// <MINUTE>
-#define BUILD_MINUTE_0 ((__TIME__[3] == ' ') ? 0 : (__TIME__[3] - 0x30))
-#define BUILD_MINUTE_1 (__TIME__[4] - 0x30)
-#define BUILD_MINUTE ((BUILD_MINUTE_0 * 10) + BUILD_MINUTE_1)
-// <SECOND>
-#define BUILD_SECOND_0 ((__TIME__[6] == ' ') ? 0 : (__TIME__[6] - 0x30))
-#define BUILD_SECOND_1 (__TIME__[7] - 0x30)
-#define BUILD_SECOND ((BUILD_SECOND_0 * 10) + BUILD_SECOND_1)
+// Parse the __DATE__ and __TIME__ predefined macros at compile time. Everything here is constexpr
+// (C++11 style, one return statement each) so setToCompilerTime() only has to copy the finished register image.
+// __DATE__ Format: MMM DD YYYY (First D may be a space if <10)
+// __TIME__ Format: HH:MM:SS
+static constexpr uint8_t buildMonth(const char* date)
+{
+    return (date[0] == 'J') ? ((date[1] == 'a') ? 1 : ((date[2] == 'n') ? 6 : 7))
+         : (date[0] == 'F') ? 2
+         : (date[0] == 'M') ? ((date[2] == 'r') ? 3 : 5)
+         : (date[0] == 'A') ? ((date[1] == 'p') ? 4 : 8)
+         : (date[0] == 'S') ? 9
+         : (date[0] == 'O') ? 10
+         : (date[0] == 'N') ? 11
+         : 12;
+}
+
+static constexpr uint8_t buildTwoDigits(const char* str)
+{
+    return ((str[0] == ' ') ? 0 : ((str[0] - '0') * 10)) + (str[1] - '0');
+}
+
+static constexpr uint16_t buildYear(const char* date)
+{
+    return ((date[7] - '0') * 1000) + ((date[8] - '0') * 100) + ((date[9] - '0') * 10) + (date[10] - '0');
+}
+
+// Days since 1970-01-01. Y is the year counted from March, so the leap day is the last day of the year
+static constexpr int32_t buildDaysFromMarchYear(int32_t Y, uint8_t month, uint8_t date)
+{
+    return (365L * Y) + (Y / 4) - (Y / 100) + (Y / 400) + ((153 * ((month > 2) ? month - 3 : month + 9)) + 2) / 5 + date - 1 - 719468L;
+}
+
+static constexpr int32_t buildSeconds()
+{
+    return (buildDaysFromMarchYear(buildYear(__DATE__) - (buildMonth(__DATE__) <= 2), buildMonth(__DATE__), buildTwoDigits(&__DATE__[4])) * 86400L)
+         + (buildTwoDigits(&__TIME__[0]) * 3600L) + (buildTwoDigits(&__TIME__[3]) * 60L) + buildTwoDigits(&__TIME__[6])
+         + RV8803_UPLOAD_LATENCY_SECONDS + (RV8803_COMPILER_TIME_OFFSET_QUARTER_HOURS * 900L);
+}
+
+// Break the adjusted epoch back down into a date (http://howardhinnant.github.io/date_algorithms.html)
+static constexpr int32_t COMPILER_EPOCH = buildSeconds();
+static constexpr int32_t COMPILER_DAYS = COMPILER_EPOCH / 86400L;
+static constexpr uint32_t COMPILER_DAY_OF_ERA = (COMPILER_DAYS + 719468L) % 146097L;
+static constexpr uint32_t COMPILER_YEAR_OF_ERA = (COMPILER_DAY_OF_ERA - (COMPILER_DAY_OF_ERA / 1460) + (COMPILER_DAY_OF_ERA / 36524) - (COMPILER_DAY_OF_ERA / 146096)) / 365;
+static constexpr uint32_t COMPILER_DAY_OF_YEAR = COMPILER_DAY_OF_ERA - ((365 * COMPILER_YEAR_OF_ERA) + (COMPILER_YEAR_OF_ERA / 4) - (COMPILER_YEAR_OF_ERA / 100));
+static constexpr uint32_t COMPILER_MP = ((5 * COMPILER_DAY_OF_YEAR) + 2) / 153;
+static constexpr uint8_t COMPILER_MONTH = (COMPILER_MP < 10) ? COMPILER_MP + 3 : COMPILER_MP - 9;
+static constexpr uint16_t COMPILER_YEAR = COMPILER_YEAR_OF_ERA + (((COMPILER_DAYS + 719468L) / 146097L) * 400) + (COMPILER_MONTH <= 2);
+
+static_assert((COMPILER_YEAR >= 2000) && (COMPILER_YEAR <= 2099), "The RV8803 can only hold years 2000 to 2099");
 
+static constexpr uint8_t buildBCD(uint32_t val)
+{
+    return ((val / 10) << 4) | (val % 10);
+}
+
+// The time registers, in the same order as _time. Weekday is counted from Thursday 1970-01-01
+static constexpr uint8_t compilerTime[TIME_ARRAY_LENGTH] = {
+    0,
+    buildBCD(COMPILER_EPOCH % 60),
+    buildBCD((COMPILER_EPOCH / 60) % 60),
+    buildBCD((COMPILER_EPOCH / 3600) % 24),
+    (uint8_t)(1 << ((COMPILER_DAYS + 4) % 7)),
+    buildBCD(COMPILER_DAY_OF_YEAR - (((153 * COMPILER_MP) + 2) / 5) + 1),
+    buildBCD(COMPILER_MONTH),
+    buildBCD(COMPILER_YEAR - 2000)
+};
+
+// Convert an endTransmission() return code into an RV8803_Result
+static RV8803_Result endTransmissionResult(uint8_t status)
+{
+    if (status > RV8803_ERROR_TIMEOUT)
+        return RV8803_ERROR_BUS; // Unknown core-specific code
+    return (RV8803_Result)status;
+}
 
 RV8803::RV8803(void)
 {
@@ -67,16 +104,68 @@ RV8803::RV8803(void)
 
 bool RV8803::begin(TwoWire& wirePort)
 {
+    BusLock lock(*this);
     _i2cPort = &wirePort;
 
     _i2cPort->beginTransmission(RV8803_ADDR);
 
-    if (_i2cPort->endTransmission() != 0) {
+    _lastError = endTransmissionResult(_i2cPort->endTransmission());
+    if (_lastError != RV8803_SUCCESS) {
         return (false); // Error: Sensor did not ack
     }
     return (true);
 }
 
+// Failed transactions are retried up to maxRetries times. The wait before each retry starts at
+// initialBackoffMicros and doubles every time, but no retry is started once deadlineMicros
+// have passed since the first attempt. Use setRetryPolicy(0) to fail on the first error.
+void RV8803::setRetryPolicy(uint8_t maxRetries, uint16_t initialBackoffMicros, uint32_t deadlineMicros)
+{
+    _maxRetries = maxRetries;
+    _initialBackoffMicros = initialBackoffMicros;
+    _deadlineMicros = deadlineMicros;
+}
+
+// A slave that was reset mid-read can hold SDA low forever. Give the SCL and SDA pin numbers
+// here and the library will clock SCL until SDA is released before each retry.
+void RV8803::setBusRecoveryPins(uint8_t sclPin, uint8_t sdaPin)
+{
+    _sclPin = sclPin;
+    _sdaPin = sdaPin;
+}
+
+// For cores where the pins cannot be driven directly (or need extra work to recover),
+// supply your own recovery function. It is called before each retry.
+void RV8803::setBusRecoveryCallback(void (*recoverBus)(TwoWire &wirePort))
+{
+    _recoverBus = recoverBus;
+}
+
+// When the TwoWire port is shared between tasks, give the library a lock. It is taken around every bus
+// transaction and around every read-modify-write or multi-transaction operation, so nothing else can
+// use the port part way through. Operations nest, so the lock must be recursive, e.g.:
+//   FreeRTOS: xSemaphoreTakeRecursive() / xSemaphoreGiveRecursive() on a xSemaphoreCreateRecursiveMutex()
+//   Linux:    std::recursive_mutex::lock() / unlock(), passing the mutex as the context
+// A single register access takes the lock per attempt, so other tasks get the port while it waits between retries.
+// An operation made of several transactions holds the lock from start to finish, so for that one the lock stays
+// held through any backoff and bus recovery: another task can wait up to the retry deadline per transaction.
+// The lock is not held while setTimePrecise() waits for its target instant (it is taken RV8803_PRECISE_SET_LEAD_US
+// before it), while setTimeFromNMEA() waits for the PPS pulse, or while serviceInterrupts() and
+// serviceTimeUpdates() call the handlers and subscribers (unless the caller holds it).
+void RV8803::setLockCallbacks(RV8803_LockCallback lock, RV8803_LockCallback unlock, void *context)
+{
+    _lock = lock;
+    _unlock = unlock;
+    _lockContext = context;
+}
+
+// Returns the result of the most recent bus transaction. Use this after the getters that
+// return a register value to find out if that value actually came from the RTC.
+RV8803_Result RV8803::getLastError()
+{
+    return _lastError;
+}
+
 // Configures the microcontroller to convert to 12 hour mode.
 void RV8803::set12Hour()
 {
@@ -108,28 +197,28 @@ bool RV8803::isPM()
 // Returns the date in MM/DD/YYYY format.
 char* RV8803::stringDateUSA(char* buffer, size_t len)
 {
-    snprintf(buffer, len, "%02d/%02d/20%02d", BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_DATE]), BCDtoDEC(_time[TIME_YEAR]));
+    snprintf(buffer, len, "%02X/%02X/20%02X", _time[TIME_MONTH], _time[TIME_DATE], _time[TIME_YEAR]); // BCD, so hex prints the decimal digits: always two, which keeps -Wformat-truncation quiet
     return (buffer);
 }
 
 // Returns the date in MM/DD/YYYY format.
 char* RV8803::stringDateUSA()
 {
-    static char dateUSA[11]; // Max of mm/dd/yyyy with \0 terminator
+    static char dateUSA[RV8803_DATE_STRING_LENGTH]; // Max of mm/dd/yyyy with \0 terminator
     return stringDateUSA(dateUSA, sizeof(dateUSA));
 }
 
 // Returns the date in the DD/MM/YYYY format.
 char* RV8803::stringDate(char* buffer, size_t len)
 {
-    snprintf(buffer, len, "%02d/%02d/20%02d", BCDtoDEC(_time[TIME_DATE]), BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_YEAR]));
+    snprintf(buffer, len, "%02X/%02X/20%02X", _time[TIME_DATE], _time[TIME_MONTH], _time[TIME_YEAR]); // BCD, like stringDateUSA()
     return (buffer);
 }
 
 // Returns the date in the DD/MM/YYYY format.
 char* RV8803::stringDate()
 {
-    static char date[11]; // Max of dd/mm/yyyy with \0 terminator
+    static char date[RV8803_DATE_STRING_LENGTH]; // Max of dd/mm/yyyy with \0 terminator
     return stringDate(date, sizeof(date));
 }
 
@@ -145,9 +234,9 @@ char* RV8803::stringTime(char* buffer, size_t len)
                 twelveHourCorrection = 12;
             }
         }
-        snprintf(buffer, len, "%02d:%02d:%02d%cM", BCDtoDEC(_time[TIME_HOURS]) - twelveHourCorrection, BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]), half);
+        snprintf(buffer, len, "%02X:%02X:%02X%cM", DECtoBCD(BCDtoDEC(_time[TIME_HOURS]) - twelveHourCorrection), _time[TIME_MINUTES], _time[TIME_SECONDS], half);
     } else
-        snprintf(buffer, len, "%02d:%02d:%02d", BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]));
+        snprintf(buffer, len, "%02X:%02X:%02X", _time[TIME_HOURS], _time[TIME_MINUTES], _time[TIME_SECONDS]);
 
     return (buffer);
 }
@@ -155,13 +244,16 @@ char* RV8803::stringTime(char* buffer, size_t len)
 // Returns the time in hh:mm:ss (Adds AM/PM if in 12 hour mode).
 char* RV8803::stringTime()
 {
-    static char time[11];
+    static char time[RV8803_TIME_STRING_LENGTH]; // Max of hh:mm:ssXM with \0 terminator
     return stringTime(time, sizeof(time));
 }
 
 // Returns the most recent timestamp captured on the EVI pin (if the EVI pin has been configured to capture events)
 char* RV8803::stringTimestamp(char* buffer, size_t len)
 {
+    uint8_t capture[2] = {0, 0}; // Hundredths and seconds capture, read in one go so they match
+    readMultipleRegisters(RV8803_HUNDREDTHS_CAPTURE, capture, 2);
+
     if (is12Hour() == true) {
         char half = 'A';
         uint8_t twelveHourCorrection = 0;
@@ -171,32 +263,31 @@ char* RV8803::stringTimestamp(char* buffer, size_t len)
                 twelveHourCorrection = 12;
             }
         }
-        snprintf(buffer, len, "%02d:%02d:%02d:%02d%cM", BCDtoDEC(_time[TIME_HOURS]) - twelveHourCorrection, BCDtoDEC(_time[TIME_MINUTES]),
-                                                        BCDtoDEC(readRegister(RV8803_SECONDS_CAPTURE)), BCDtoDEC(readRegister(RV8803_HUNDREDTHS_CAPTURE)), half);
+        snprintf(buffer, len, "%02X:%02X:%02X:%02X%cM", DECtoBCD(BCDtoDEC(_time[TIME_HOURS]) - twelveHourCorrection), _time[TIME_MINUTES],
+                                                        capture[1], capture[0], half);
     } else
-        snprintf(buffer, len, "%02d:%02d:%02d:%02d", BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]),
-                                                     BCDtoDEC(readRegister(RV8803_SECONDS_CAPTURE)), BCDtoDEC(readRegister(RV8803_HUNDREDTHS_CAPTURE)));
+        snprintf(buffer, len, "%02X:%02X:%02X:%02X", _time[TIME_HOURS], _time[TIME_MINUTES], capture[1], capture[0]);
 
     return (buffer);
 }
 
 char* RV8803::stringTimestamp()
 {
-    static char timestamp[14]; // Max of hh:mm:ss:HHXM with \0 terminator
+    static char timestamp[RV8803_TIMESTAMP_STRING_LENGTH]; // Max of hh:mm:ss:HHXM with \0 terminator
     return stringTimestamp(timestamp, sizeof(timestamp));
 }
 
 // Returns timestamp in ISO 8601 format (yyyy-mm-ddThh:mm:ss).
 char* RV8803::stringTime8601(char* buffer, size_t len)
 {
-    snprintf(buffer, len, "20%02d-%02d-%02dT%02d:%02d:%02d", BCDtoDEC(_time[TIME_YEAR]), BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_DATE]),
-                                                             BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]));
+    snprintf(buffer, len, "20%02X-%02X-%02XT%02X:%02X:%02X", _time[TIME_YEAR], _time[TIME_MONTH], _time[TIME_DATE],
+                                                             _time[TIME_HOURS], _time[TIME_MINUTES], _time[TIME_SECONDS]);
     return (buffer);
 }
 
 char* RV8803::stringTime8601()
 {
-    static char time8601[21]; // Max of yyyy-mm-ddThh:mm:ss with \0 terminator
+    static char time8601[RV8803_TIME8601_STRING_LENGTH]; // Max of yyyy-mm-ddThh:mm:ss with \0 terminator
     return stringTime8601(time8601, sizeof(time8601));
 }
 
@@ -213,381 +304,365 @@ char* RV8803::stringTime8601TZ(char* buffer, size_t len)
     uint16_t mins = quarterHours * 15;
     uint8_t tzh = mins / 60;
     uint8_t tzm = mins % 60;
-    snprintf(buffer, len, "20%02d-%02d-%02dT%02d:%02d:%02d%c%02d:%02d", BCDtoDEC(_time[TIME_YEAR]), BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_DATE]),
-                                                             BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]),
-                                                             plusMinus, tzh, tzm);
+    snprintf(buffer, len, "20%02X-%02X-%02XT%02X:%02X:%02X%c%02X:%02X", _time[TIME_YEAR], _time[TIME_MONTH], _time[TIME_DATE],
+                                                             _time[TIME_HOURS], _time[TIME_MINUTES], _time[TIME_SECONDS],
+                                                             plusMinus, DECtoBCD(tzh), DECtoBCD(tzm));
     return (buffer);
 }
 
 char* RV8803::stringTime8601TZ()
 {
-    static char time8601tz[27]; // Max of yyyy-mm-ddThh:mm:ss+hh:mm with \0 terminator
+    static char time8601tz[RV8803_TIME8601TZ_STRING_LENGTH]; // Max of yyyy-mm-ddThh:mm:ss+hh:mm with \0 terminator
     return stringTime8601TZ(time8601tz, sizeof(time8601tz));
 }
 
+// Day and month names for the selected RV8803_LOCALE, stored in flash as fixed-width tables
+// indexed directly by the decoded field
+#if RV8803_LOCALE == RV8803_LOCALE_DE
+static const char dayNames[7][RV8803_DAY_STRING_LENGTH] PROGMEM = { "Sonntag", "Montag", "Dienstag", "Mittwoch", "Donnerstag", "Freitag", "Samstag" };
+static const char dayNamesShort[7][RV8803_DAY_SHORT_STRING_LENGTH] PROGMEM = { "So", "Mo", "Di", "Mi", "Do", "Fr", "Sa" };
+static const char monthNames[12][RV8803_MONTH_STRING_LENGTH] PROGMEM = { "Januar", "Februar", "März", "April", "Mai", "Juni", "Juli", "August", "September", "Oktober", "November", "Dezember" };
+static const char monthNamesShort[12][RV8803_MONTH_SHORT_STRING_LENGTH] PROGMEM = { "Jan", "Feb", "Mär", "Apr", "Mai", "Jun", "Jul", "Aug", "Sep", "Okt", "Nov", "Dez" };
+static const char ordinalSuffixes[1][3] PROGMEM = { "." };
+#elif RV8803_LOCALE == RV8803_LOCALE_FR
+static const char dayNames[7][RV8803_DAY_STRING_LENGTH] PROGMEM = { "dimanche", "lundi", "mardi", "mercredi", "jeudi", "vendredi", "samedi" };
+static const char dayNamesShort[7][RV8803_DAY_SHORT_STRING_LENGTH] PROGMEM = { "dim", "lun", "mar", "mer", "jeu", "ven", "sam" };
+static const char monthNames[12][RV8803_MONTH_STRING_LENGTH] PROGMEM = { "janvier", "février", "mars", "avril", "mai", "juin", "juillet", "août", "septembre", "octobre", "novembre", "décembre" };
+static const char monthNamesShort[12][RV8803_MONTH_SHORT_STRING_LENGTH] PROGMEM = { "jan", "fév", "mar", "avr", "mai", "jun", "jul", "aoû", "sep", "oct", "nov", "déc" };
+static const char ordinalSuffixes[2][3] PROGMEM = { "e", "er" };
+#elif RV8803_LOCALE == RV8803_LOCALE_ES
+static const char dayNames[7][RV8803_DAY_STRING_LENGTH] PROGMEM = { "domingo", "lunes", "martes", "miércoles", "jueves", "viernes", "sábado" };
+static const char dayNamesShort[7][RV8803_DAY_SHORT_STRING_LENGTH] PROGMEM = { "dom", "lun", "mar", "mié", "jue", "vie", "sáb" };
+static const char monthNames[12][RV8803_MONTH_STRING_LENGTH] PROGMEM = { "enero", "febrero", "marzo", "abril", "mayo", "junio", "julio", "agosto", "septiembre", "octubre", "noviembre", "diciembre" };
+static const char monthNamesShort[12][RV8803_MONTH_SHORT_STRING_LENGTH] PROGMEM = { "ene", "feb", "mar", "abr", "may", "jun", "jul", "ago", "sep", "oct", "nov", "dic" };
+static const char ordinalSuffixes[1][3] PROGMEM = { "º" };
+#else
+static const char dayNames[7][RV8803_DAY_STRING_LENGTH] PROGMEM = { "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
+static const char dayNamesShort[7][RV8803_DAY_SHORT_STRING_LENGTH] PROGMEM = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char monthNames[12][RV8803_MONTH_STRING_LENGTH] PROGMEM = { "January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December" };
+static const char monthNamesShort[12][RV8803_MONTH_SHORT_STRING_LENGTH] PROGMEM = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+static const char ordinalSuffixes[4][3] PROGMEM = { "th", "st", "nd", "rd" };
+#endif
+
+// Which entry of ordinalSuffixes each date (1-31) uses. Entry 0 is the fallback for an invalid date
+static const uint8_t ordinalSuffixIndex[32] PROGMEM = {
+#if RV8803_LOCALE == RV8803_LOCALE_EN
+    0, 1, 2, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 0, 0, 0, 0, 0, 0, 0, 1
+#elif RV8803_LOCALE == RV8803_LOCALE_FR
+    0, 1 // 1er, then 2e, 3e...
+#else
+    0
+#endif
+};
+
+// Copy a name out of flash, truncating it to fit the buffer. Every row of the tables is terminated within its width,
+// so this never reads past the row
+static char* copyName(char* buffer, size_t len, const char* name)
+{
+    if (len == 0)
+        return buffer;
+    size_t i = 0;
+    for (char c; (i < len - 1) && ((c = pgm_read_byte(name + i)) != '\0'); i++)
+        buffer[i] = c;
+    buffer[i] = '\0';
+    return buffer;
+}
+
+// An invalid weekday reads as Saturday and an invalid month as December, as they always have
+static uint8_t dayIndex(uint8_t weekday)
+{
+    return (weekday > 6) ? 6 : weekday;
+}
+
+static uint8_t monthIndex(uint8_t month)
+{
+    return ((month < 1) || (month > 12)) ? 11 : month - 1;
+}
+
 char* RV8803::stringDayOfWeek(char *buffer, size_t len)
 {
-    switch (getWeekday())
-    {
-        case 0:
-            snprintf(buffer, len, "Sunday");
-            return(buffer);
-            break;
-        case 1:
-            snprintf(buffer, len, "Monday");
-            return(buffer);
-            break;
-        case 2:
-            snprintf(buffer, len, "Tuesday");
-            return(buffer);
-            break;
-        case 3:
-            snprintf(buffer, len, "Wednesday");
-            return(buffer);
-            break;
-        case 4:
-            snprintf(buffer, len, "Thursday");
-            return(buffer);
-            break;
-        case 5:
-            snprintf(buffer, len, "Friday");
-            return(buffer);
-            break;
-        default:
-            snprintf(buffer, len, "Saturday");
-            return(buffer);
-            break;
-    }
+    return copyName(buffer, len, dayNames[dayIndex(getWeekday())]);
 }
 
 char* RV8803::stringDayOfWeek()
 {
-    static char timeDOW[11]; // Max of day with \0 terminator
+    static char timeDOW[RV8803_DAY_STRING_LENGTH]; // Max of day with \0 terminator
     return stringDayOfWeek(timeDOW, sizeof(timeDOW));
 }
 
 char* RV8803::stringDayOfWeekShort(char *buffer, size_t len)
 {
-    switch (getWeekday())
-    {
-        case 0:
-            snprintf(buffer, len, "Sun");
-            return(buffer);
-            break;
-        case 1:
-            snprintf(buffer, len, "Mon");
-            return(buffer);
-            break;
-        case 2:
-            snprintf(buffer, len, "Tue");
-            return(buffer);
-            break;
-        case 3:
-            snprintf(buffer, len, "Wed");
-            return(buffer);
-            break;
-        case 4:
-            snprintf(buffer, len, "Thu");
-            return(buffer);
-            break;
-        case 5:
-            snprintf(buffer, len, "Fri");
-            return(buffer);
-            break;
-        default:
-            snprintf(buffer, len, "Sat");
-            return(buffer);
-            break;
-    }
+    return copyName(buffer, len, dayNamesShort[dayIndex(getWeekday())]);
 }
 
 char* RV8803::stringDayOfWeekShort()
 {
-    static char timeDOWs[5]; // Max of day with \0 terminator
+    static char timeDOWs[RV8803_DAY_SHORT_STRING_LENGTH]; // Max of day with \0 terminator
     return stringDayOfWeekShort(timeDOWs, sizeof(timeDOWs));
 }
 
 char* RV8803::stringDateOrdinal(char *buffer, size_t len)
 {
-    switch (getDate())
-    {
-        case 1:
-        case 21:
-        case 31:
-            snprintf(buffer, len, "%dst", getDate());
-            return(buffer);
-            break;
-        case 2:
-        case 22:
-            snprintf(buffer, len, "%dnd", getDate());
-            return(buffer);
-            break;
-        case 3:
-        case 23:
-            snprintf(buffer, len, "%drd", getDate());
-            return(buffer);
-            break;
-        default:
-            snprintf(buffer, len, "%dth", getDate());
-            return(buffer);
-            break;
-    }
+    uint8_t date = getDate();
+    if (date > 31)
+        date = 0;
+
+    char digits[3];
+    uint8_t i = 0;
+    if (date >= 10)
+        digits[i++] = '0' + (date / 10);
+    digits[i++] = '0' + (date % 10);
+    digits[i] = '\0';
+
+    size_t used = (i < len) ? i : 0;
+    if (len > 0)
+        memcpy(buffer, digits, used);
+    copyName(buffer + used, len - used, ordinalSuffixes[pgm_read_byte(&ordinalSuffixIndex[date])]);
+    return buffer;
 }
 
 char* RV8803::stringDateOrdinal()
 {
-    static char timeOrdinal[6]; // Max of ordinal with \0 terminator
+    static char timeOrdinal[RV8803_ORDINAL_STRING_LENGTH]; // Max of ordinal with \0 terminator
     return stringDateOrdinal(timeOrdinal, sizeof(timeOrdinal));
 }
 
 char* RV8803::stringMonth(char *buffer, size_t len)
 {
-    switch (getMonth())
-    {
-        case 1:
-            snprintf(buffer, len, "January");
-            return(buffer);
-            break;
-        case 2:
-            snprintf(buffer, len, "February");
-            return(buffer);
-            break;
-        case 3:
-            snprintf(buffer, len, "March");
-            return(buffer);
-            break;
-        case 4:
-            snprintf(buffer, len, "April");
-            return(buffer);
-            break;
-        case 5:
-            snprintf(buffer, len, "May");
-            return(buffer);
-            break;
-        case 6:
-            snprintf(buffer, len, "June");
-            return(buffer);
-            break;
-        case 7:
-            snprintf(buffer, len, "July");
-            return(buffer);
-            break;
-        case 8:
-            snprintf(buffer, len, "August");
-            return(buffer);
-            break;
-        case 9:
-            snprintf(buffer, len, "September");
-            return(buffer);
-            break;
-        case 10:
-            snprintf(buffer, len, "October");
-            return(buffer);
-            break;
-        case 11:
-            snprintf(buffer, len, "November");
-            return(buffer);
-            break;
-        default:
-            snprintf(buffer, len, "December");
-            return(buffer);
-            break;
-    }
+    return copyName(buffer, len, monthNames[monthIndex(getMonth())]);
 }
 
 char* RV8803::stringMonth()
 {
-    static char timeMonth[11]; // Max of month with \0 terminator
+    static char timeMonth[RV8803_MONTH_STRING_LENGTH]; // Max of month with \0 terminator
     return stringMonth(timeMonth, sizeof(timeMonth));
 }
 
 char* RV8803::stringMonthShort(char *buffer, size_t len)
 {
-    switch (getMonth())
-    {
-        case 1:
-            snprintf(buffer, len, "Jan");
-            return(buffer);
-            break;
-        case 2:
-            snprintf(buffer, len, "Feb");
-            return(buffer);
-            break;
-        case 3:
-            snprintf(buffer, len, "Mar");
-            return(buffer);
-            break;
-        case 4:
-            snprintf(buffer, len, "Apr");
-            return(buffer);
-            break;
-        case 5:
-            snprintf(buffer, len, "May");
-            return(buffer);
-            break;
-        case 6:
-            snprintf(buffer, len, "Jun");
-            return(buffer);
-            break;
-        case 7:
-            snprintf(buffer, len, "Jul");
-            return(buffer);
-            break;
-        case 8:
-            snprintf(buffer, len, "Aug");
-            return(buffer);
-            break;
-        case 9:
-            snprintf(buffer, len, "Sep");
-            return(buffer);
-            break;
-        case 10:
-            snprintf(buffer, len, "Oct");
-            return(buffer);
-            break;
-        case 11:
-            snprintf(buffer, len, "Nov");
-            return(buffer);
-            break;
-        default:
-            snprintf(buffer, len, "Dec");
-            return(buffer);
-            break;
-    }
+    return copyName(buffer, len, monthNamesShort[monthIndex(getMonth())]);
 }
 
 char* RV8803::stringMonthShort()
 {
-    static char timeMonths[5]; // Max of month with \0 terminator
+    static char timeMonths[RV8803_MONTH_SHORT_STRING_LENGTH]; // Max of month with \0 terminator
     return stringMonthShort(timeMonths, sizeof(timeMonths));
 }
 
-// Returns time in UNIX Epoch time format, adjusting for the time zone
-uint32_t RV8803::getEpoch(bool use1970sEpoch)
+// The format...() functions return their text by value in a buffer sized for the format,
+// so they are safe to call from several tasks or several times in one expression.
+RV8803_DateString RV8803::formatDateUSA()
+{
+    RV8803_DateString result;
+    stringDateUSA(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_DateString RV8803::formatDate()
+{
+    RV8803_DateString result;
+    stringDate(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_TimeString RV8803::formatTime()
+{
+    RV8803_TimeString result;
+    stringTime(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_TimestampString RV8803::formatTimestamp()
+{
+    RV8803_TimestampString result;
+    stringTimestamp(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_Time8601String RV8803::formatTime8601()
+{
+    RV8803_Time8601String result;
+    stringTime8601(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_Time8601TZString RV8803::formatTime8601TZ()
 {
+    RV8803_Time8601TZString result;
+    stringTime8601TZ(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_DayString RV8803::formatDayOfWeek()
+{
+    RV8803_DayString result;
+    stringDayOfWeek(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_DayShortString RV8803::formatDayOfWeekShort()
+{
+    RV8803_DayShortString result;
+    stringDayOfWeekShort(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_OrdinalString RV8803::formatDateOrdinal()
+{
+    RV8803_OrdinalString result;
+    stringDateOrdinal(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_MonthString RV8803::formatMonth()
+{
+    RV8803_MonthString result;
+    stringMonth(result.buffer, sizeof(result.buffer));
+    return result;
+}
+
+RV8803_MonthShortString RV8803::formatMonthShort()
+{
+    RV8803_MonthShortString result;
+    stringMonthShort(result.buffer, sizeof(result.buffer));
+    return result;
+}
 
+// Days since 2000-01-01 of a Gregorian date (http://howardhinnant.github.io/date_algorithms.html)
+static int32_t daysFromCivil(uint16_t year, uint8_t month, uint8_t date)
+{
+    int32_t y = (int32_t)year - (month <= 2);
+    int32_t era = y / 400;
+    uint32_t yearOfEra = y - (era * 400);
+    uint32_t dayOfYear = ((153 * (month > 2 ? month - 3 : month + 9)) + 2) / 5 + date - 1;
+    uint32_t dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+    return (era * 146097) + (int32_t)dayOfEra - 730425; // 730425 days from 0000-03-01 to 2000-01-01
+}
+
+// The inverse of daysFromCivil(). days must be >= -730425
+static void civilFromDays(int32_t days, uint16_t &year, uint8_t &month, uint8_t &date)
+{
+    uint32_t z = days + 730425;
+    uint32_t era = z / 146097;
+    uint32_t dayOfEra = z - (era * 146097);
+    uint32_t yearOfEra = (dayOfEra - (dayOfEra / 1460) + (dayOfEra / 36524) - (dayOfEra / 146096)) / 365;
+    uint32_t dayOfYear = dayOfEra - ((365 * yearOfEra) + (yearOfEra / 4) - (yearOfEra / 100));
+    uint32_t mp = ((5 * dayOfYear) + 2) / 153;
+    date = dayOfYear - (((153 * mp) + 2) / 5) + 1;
+    month = (mp < 10) ? mp + 3 : mp - 9;
+    year = yearOfEra + (era * 400) + (month <= 2);
+}
+
+// Fills in the date and time fields of a time array laid out like _time. days must be 0 to 36524 (2000 to 2099)
+static void timeFromDays(uint8_t* time, int32_t days, int32_t secondOfDay)
+{
+    uint16_t year;
+    uint8_t month, date;
+    civilFromDays(days, year, month, date);
+    time[TIME_SECONDS] = RV8803::DECtoBCD(secondOfDay % 60);
+    time[TIME_MINUTES] = RV8803::DECtoBCD((secondOfDay / 60) % 60);
+    time[TIME_HOURS] = RV8803::DECtoBCD(secondOfDay / 3600);
+    time[TIME_WEEKDAY] = 1 << ((days + 6) % 7); // 2000-01-01 was a Saturday
+    time[TIME_DATE] = RV8803::DECtoBCD(date);
+    time[TIME_MONTH] = RV8803::DECtoBCD(month);
+    time[TIME_YEAR] = RV8803::DECtoBCD(year - 2000);
+}
 
-    // Okay, we need the non system timezone adjusted value in ticks.
-    // use our internal _timegm() method to do this. 
+// Milliseconds since 2000-01-01 00:00:00.00 of a time array laid out like _time
+static int64_t millisFromTime(const uint8_t* time)
+{
+    int32_t days = daysFromCivil(RV8803::BCDtoDEC(time[TIME_YEAR]) + 2000, RV8803::BCDtoDEC(time[TIME_MONTH]), RV8803::BCDtoDEC(time[TIME_DATE]));
+    int32_t msOfDay = (((((RV8803::BCDtoDEC(time[TIME_HOURS]) * 60L) + RV8803::BCDtoDEC(time[TIME_MINUTES])) * 60L) + RV8803::BCDtoDEC(time[TIME_SECONDS])) * 1000L)
+                    + (RV8803::BCDtoDEC(time[TIME_HUNDREDTHS]) * 10L);
+    return ((int64_t)days * 86400000LL) + msOfDay;
+}
 
-    struct tm tm;
+#define SECONDS_FROM_1970_TO_2000	946684800L
 
-    tm.tm_isdst = -1;
-    tm.tm_yday = 0;
-    tm.tm_wday = 0;
-    tm.tm_year = BCDtoDEC(_time[TIME_YEAR]) + 100;
-    tm.tm_mon = BCDtoDEC(_time[TIME_MONTH]) - 1;
-    tm.tm_mday = BCDtoDEC(_time[TIME_DATE]);
-    tm.tm_hour = BCDtoDEC(_time[TIME_HOURS]);
-    tm.tm_min = BCDtoDEC(_time[TIME_MINUTES]);
-    tm.tm_sec = BCDtoDEC(_time[TIME_SECONDS]);
+// avr-libc's time_t counts from 2000 (its time.h defines UNIX_OFFSET, the seconds from 1970 to then). Everyone
+// else's counts from 1970
+#ifdef UNIX_OFFSET
+#define SECONDS_FROM_TIME_T_EPOCH_TO_2000	0L
+#else
+#define SECONDS_FROM_TIME_T_EPOCH_TO_2000	SECONDS_FROM_1970_TO_2000
+#endif
 
-    // Call our internal version of timegm() (some systems don't have this)
-    // to get the value from our clock, without taking into the systems TimeZone.
+// Returns time in UNIX Epoch time format, adjusting for the time zone
+uint32_t RV8803::getEpoch(bool use1970sEpoch)
+{
+    return epochFromTime(_time, use1970sEpoch);
+}
 
-    time_t t = _timegm(&tm, use1970sEpoch);
+// Converts a snapshot laid out like _time into UNIX Epoch time format, adjusting for the time zone
+uint32_t RV8803::epochFromTime(const uint8_t* time, bool use1970sEpoch)
+{
+    uint32_t t = localEpochFromTime(time, use1970sEpoch);
 
     // If the user has added any timezone info, roll that in.
 
     // see if the user set any timezone values
     int32_t tzOffset = (int32_t)getTimeZoneQuarterHours() * 15 * 60;
 
-    t -= tzOffset;
-
-
-    // For backward compatablity
-    if (use1970sEpoch) {
-        // AVR GCC compiler sets the Epoch time to Jan 1st, 2000. We can
-        // increase the offset to Jan 1st, 1970 if folks want that format
-        t += 946684800;
-    }
-    return t;
+    return t - tzOffset;
+}
 
+// Converts a snapshot laid out like _time into UNIX Epoch time format, without the time zone.
+// The result counts from 1970 if use1970sEpoch is true, otherwise from the epoch of the platform's time_t (2000 on
+// AVR, 1970 everywhere else), the same as the value setEpoch() and setLocalEpoch() take
+uint32_t RV8803::localEpochFromTime(const uint8_t* time, bool use1970sEpoch)
+{
+    int32_t days = daysFromCivil(BCDtoDEC(time[TIME_YEAR]) + 2000, BCDtoDEC(time[TIME_MONTH]), BCDtoDEC(time[TIME_DATE]));
+    uint32_t secondOfDay = (BCDtoDEC(time[TIME_HOURS]) * 3600L) + (BCDtoDEC(time[TIME_MINUTES]) * 60L) + BCDtoDEC(time[TIME_SECONDS]);
+    return (use1970sEpoch ? SECONDS_FROM_1970_TO_2000 : SECONDS_FROM_TIME_T_EPOCH_TO_2000) + ((uint32_t)days * 86400UL) + secondOfDay;
 }
 
 // Returns local time in UNIX Epoch time format
 uint32_t RV8803::getLocalEpoch(bool use1970sEpoch)
 {
-    struct tm tm;
-
-    tm.tm_isdst = -1;
-    tm.tm_yday = 0;
-    tm.tm_wday = 0;
-    tm.tm_year = BCDtoDEC(_time[TIME_YEAR]) + 100;
-    tm.tm_mon = BCDtoDEC(_time[TIME_MONTH]) - 1;
-    tm.tm_mday = BCDtoDEC(_time[TIME_DATE]);
-    tm.tm_hour = BCDtoDEC(_time[TIME_HOURS]);
-    tm.tm_min = BCDtoDEC(_time[TIME_MINUTES]);
-    tm.tm_sec = BCDtoDEC(_time[TIME_SECONDS]);
-
-    time_t t = mktime(&tm);
+    return localEpochFromTime(_time, use1970sEpoch);
+}
 
-    if (use1970sEpoch) {
-        // AVR GCC compiler sets the Epoch time to Jan 1st, 2000. We can
-        // increase the offset to Jan 1st, 1970 if folks want that format
-        t += 946684800;
+// Writes value + offsetSeconds to the time registers. value counts from 1970 if use1970sEpoch is true, otherwise
+// from the epoch of the platform's time_t (2000 on AVR, 1970 everywhere else).
+// Returns false if the result is outside the years the RTC can hold (2000 to 2099)
+bool RV8803::setTimeFromEpoch(uint32_t value, bool use1970sEpoch, int32_t offsetSeconds)
+{
+    int64_t seconds = (int64_t)value + offsetSeconds - (use1970sEpoch ? SECONDS_FROM_1970_TO_2000 : SECONDS_FROM_TIME_T_EPOCH_TO_2000);
+    if ((seconds < 0) || (seconds >= 36525LL * 86400)) // Seconds since 2000-01-01, up to the end of 2099
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
     }
 
-    return t;
+    timeFromDays(_time, (uint32_t)seconds / 86400UL, (uint32_t)seconds % 86400UL);
+    return setTime(_time, TIME_ARRAY_LENGTH);
 }
 
 // Sets time using UNIX Epoch time
 bool RV8803::setEpoch(uint32_t value, bool use1970sEpoch, int8_t timeZoneQuarterHours)
 {
-    if (use1970sEpoch) {
-        // AVR GCC compiler sets the Epoch time to Jan 1st, 2000. We can
-        // reduce the offset from Jan 1st, 1970 if folks want that format
-        value -= 946684800;
-    }
-
+    BusLock lock(*this);
     int32_t tzOffset = 0;
 
     if (timeZoneQuarterHours != 0)
     {
-        setTimeZoneQuarterHours(timeZoneQuarterHours); // Update timeZoneQuarterHours if desired
+        if (setTimeZoneQuarterHours(timeZoneQuarterHours) == false) // Update timeZoneQuarterHours if desired
+            return false;
         tzOffset = (int32_t)timeZoneQuarterHours * 15 * 60;
     }
     else
     {
         tzOffset = (int32_t)getTimeZoneQuarterHours() * 15 * 60;
+        if (_lastError != RV8803_SUCCESS)
+            return false; // Don't set the clock using a time zone we failed to read
     }
 
-    value += tzOffset;
-
-    time_t t = value;
-    struct tm* tmp = gmtime(&t);
-
-    _time[TIME_SECONDS] = DECtoBCD(tmp->tm_sec);
-    _time[TIME_MINUTES] = DECtoBCD(tmp->tm_min);
-    _time[TIME_HOURS] = DECtoBCD(tmp->tm_hour);
-    _time[TIME_DATE] = DECtoBCD(tmp->tm_mday);
-    _time[TIME_WEEKDAY] = 1 << tmp->tm_wday;
-    _time[TIME_MONTH] = DECtoBCD(tmp->tm_mon + 1);
-    _time[TIME_YEAR] = DECtoBCD(tmp->tm_year - 100);
-
-    return setTime(_time, TIME_ARRAY_LENGTH); // Subtract one as we don't write to the hundredths register
+    return setTimeFromEpoch(value, use1970sEpoch, tzOffset);
 }
 
 bool RV8803::setLocalEpoch(uint32_t value, bool use1970sEpoch)
 {
-    if (use1970sEpoch) {
-        // AVR GCC compiler sets the Epoch time to Jan 1st, 2000. We can
-        // reduce the offset from Jan 1st, 1970 if folks want that format
-        value -= 946684800;
-    }
-
-    time_t t = value;
-    struct tm* tmp = gmtime(&t);
-
-    _time[TIME_SECONDS] = DECtoBCD(tmp->tm_sec);
-    _time[TIME_MINUTES] = DECtoBCD(tmp->tm_min);
-    _time[TIME_HOURS] = DECtoBCD(tmp->tm_hour);
-    _time[TIME_DATE] = DECtoBCD(tmp->tm_mday);
-    _time[TIME_WEEKDAY] = 1 << tmp->tm_wday;
-    _time[TIME_MONTH] = DECtoBCD(tmp->tm_mon + 1);
-    _time[TIME_YEAR] = DECtoBCD(tmp->tm_year - 100);
-
-    return setTime(_time, TIME_ARRAY_LENGTH); // Subtract one as we don't write to the hundredths register
+    return setTimeFromEpoch(value, use1970sEpoch, 0);
 }
 
 // Set time and date/day registers of RV8803
@@ -607,187 +682,827 @@ bool RV8803::setTime(uint8_t sec, uint8_t min, uint8_t hour, uint8_t weekday, ui
 // Set time and date/day registers of RV8803 (using data array)
 bool RV8803::setTime(uint8_t* time, uint8_t len)
 {
+    BusLock lock(*this);
     if (len != TIME_ARRAY_LENGTH)
         return false;
 
     bool response = writeMultipleRegisters(RV8803_SECONDS, time + 1, len - 1); // We use length - 1 as that is the length without the read-only hundredths register We also point to the second element in the time array as hundredths is read only
 
-    writeBit(RV8803_CONTROL, CONTROL_RESET, RV8803_DISABLE); //Set RESET bit to 0 after setting time to make sure seconds don't get stuck.
+    response &= writeBit(RV8803_CONTROL, CONTROL_RESET, RV8803_DISABLE); //Set RESET bit to 0 after setting time to make sure seconds don't get stuck.
+
+    if (response)
+    {
+        noteClock(time, true);
+        response = markTimeSet();
+    }
 
     return response; 
 }
 
 bool RV8803::setHundredthsToZero()
 {
-    bool temp = writeBit(RV8803_CONTROL, CONTROL_RESET, RV8803_ENABLE);
-    temp &= writeBit(RV8803_CONTROL, CONTROL_RESET, RV8803_DISABLE);
+    BusLock lock(*this);
+    uint8_t control;
+    if (tryReadRegister(RV8803_CONTROL, control) != RV8803_SUCCESS)
+        return false;
+    bool temp = writeRegister(RV8803_CONTROL, control | (1 << CONTROL_RESET));
+    temp &= writeRegister(RV8803_CONTROL, control & ~(1 << CONTROL_RESET));
     return temp;
 }
 
-bool RV8803::setSeconds(uint8_t value)
+// Sets the time so that the RTC second starts exactly at fireAtMicros (compared with micros()).
+// The clock is held in reset while the time registers are written, then released by a single
+// CONTROL write at the target instant (CONTROL is read just before), so the bus latency of the
+// set no longer ends up in the sub-second phase. If skewHundredths is given, hundredths are read back afterwards
+// and the difference from the expected value is returned (positive = RTC ahead), in the range -50 to 49 as hundredths
+// wrap from 99 to 00.
+// fireAtMicros must be less than ~35 minutes in the future. If it has already passed, the
+// clock is started immediately.
+bool RV8803::setTimePrecise(const uint8_t* time, uint32_t fireAtMicros, int8_t* skewHundredths)
 {
-    _time[TIME_SECONDS] = DECtoBCD(value);
-    return setTime(_time, TIME_ARRAY_LENGTH);
-}
+    if (stagePreciseSet(time) == false)
+        return false;
 
-bool RV8803::setMinutes(uint8_t value)
-{
-    _time[TIME_MINUTES] = DECtoBCD(value);
-    return setTime(_time, TIME_ARRAY_LENGTH);
+    while ((int32_t)(micros() - (fireAtMicros - RV8803_PRECISE_SET_LEAD_US)) < 0)
+        ; // Wait, without the lock, until just before the target instant
+
+    if (releasePreciseSet(fireAtMicros) == false)
+        return false;
+
+    if (skewHundredths != nullptr)
+    {
+        uint8_t hundredths;
+        if (tryReadRegister(RV8803_HUNDREDTHS, hundredths) != RV8803_SUCCESS)
+            return false;
+        uint32_t expected = (micros() - fireAtMicros) / 10000;
+        int16_t skew = BCDtoDEC(hundredths) - (int16_t)(expected % 100);
+        if (skew >= 50)
+            skew -= 100; // e.g. 99 read when 00 was expected is 1 behind, not 99 ahead
+        else if (skew < -50)
+            skew += 100;
+        *skewHundredths = (int8_t)skew;
+    }
+    return true;
 }
 
-bool RV8803::setHours(uint8_t value)
+// Stops the clock (RESET = 1, which also clears hundredths) and writes the time registers
+bool RV8803::stagePreciseSet(const uint8_t* time)
 {
-    _time[TIME_HOURS] = DECtoBCD(value);
-    return setTime(_time, TIME_ARRAY_LENGTH);
+    BusLock lock(*this);
+    uint8_t control;
+    if (tryReadRegister(RV8803_CONTROL, control) != RV8803_SUCCESS)
+        return false;
+
+    if (tryWriteRegister(RV8803_CONTROL, control | (1 << CONTROL_RESET)) != RV8803_SUCCESS)
+        return false;
+    if (tryWriteMultipleRegisters(RV8803_SECONDS, time + 1, TIME_ARRAY_LENGTH - 1) != RV8803_SUCCESS)
+    {
+        tryWriteRegister(RV8803_CONTROL, control & ~(1 << CONTROL_RESET)); // Don't leave the clock stopped
+        return false;
+    }
+    memcpy(&_time[TIME_SECONDS], &time[TIME_SECONDS], TIME_ARRAY_LENGTH - 1);
+    _time[TIME_HUNDREDTHS] = 0;
+    return markTimeSet();
 }
 
-bool RV8803::setDate(uint8_t value)
+// Restarts the clock at releaseAtMicros, or straight away if that has passed. The lock may have been given up since
+// stagePreciseSet(), so CONTROL is read again rather than written back as it was: an interrupt another task enabled
+// or disabled in between stays that way. The read comes first, so only the write has to land on time
+bool RV8803::releasePreciseSet(uint32_t releaseAtMicros)
 {
-    _time[TIME_DATE] = DECtoBCD(value);
-    return setTime(_time, TIME_ARRAY_LENGTH);
+    BusLock lock(*this);
+    uint8_t control;
+    if (tryReadRegister(RV8803_CONTROL, control) != RV8803_SUCCESS)
+        return false;
+
+    while ((int32_t)(micros() - releaseAtMicros) < 0)
+        ;
+    if (tryWriteRegister(RV8803_CONTROL, control & ~(1 << CONTROL_RESET)) != RV8803_SUCCESS)
+        return false;
+    noteClock(_time, true); // stagePreciseSet() left the new time in _time
+    return true;
 }
 
-bool RV8803::setMonth(uint8_t value)
+// Sets the time from an ISO 8601 / RFC 3339 string, as produced by stringTime8601() and stringTime8601TZ():
+//   yyyy-mm-ddThh:mm:ss, optionally followed by a fraction (.s, .ss, .sss...) and a time zone (Z, +hh:mm, -hh:mm,
+//   +hhmm or +hh). A space may be used instead of the T.
+// The time registers are written in one burst with the clock held in reset, so hundredths restart from zero
+// (the fraction is not restored; use parseTime8601() and setTimePrecise() if you need it). If the string has a
+// time zone it is written to RV8803_RAM. The time zone must be a whole number of quarter hours, no more than 14 hours
+// either side of UTC.
+bool RV8803::setTime8601(const char* iso8601)
 {
-    _time[TIME_MONTH] = DECtoBCD(value);
-    return setTime(_time, TIME_ARRAY_LENGTH);
+    uint8_t time[TIME_ARRAY_LENGTH];
+    int8_t quarterHours;
+    bool hasTimeZone;
+    if (parseTime8601(iso8601, time, quarterHours, hasTimeZone) == false)
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
+    }
+
+    BusLock lock(*this);
+    if (stagePreciseSet(time) == false)
+        return false;
+    if (releasePreciseSet(micros()) == false)
+        return false;
+    if (hasTimeZone)
+        return setTimeZoneQuarterHours(quarterHours);
+    return true;
 }
 
-bool RV8803::setYear(uint16_t value)
+// Read exactly count digits. Returns false if any of them isn't a digit
+static bool parseDigits(const char* &str, uint8_t count, uint16_t &value)
 {
-    _time[TIME_YEAR] = DECtoBCD(value - 2000);
-    return setTime(_time, TIME_ARRAY_LENGTH);
+    value = 0;
+    while (count--)
+    {
+        if ((*str < '0') || (*str > '9'))
+            return false;
+        value = (value * 10) + (*str++ - '0');
+    }
+    return true;
 }
 
-bool RV8803::setWeekday(uint8_t value) // value is anywhere between 0=sunday and 6=saturday
+static bool parseSeparator(const char* &str, char separator)
 {
-    if (value > 6) {
-        value = 6;
-    }
-    _time[TIME_WEEKDAY] = 1 << value;
-    return setTime(_time, TIME_ARRAY_LENGTH);
+    if (*str != separator)
+        return false;
+    str++;
+    return true;
 }
 
-// Move the hours, mins, sec, etc registers from RV-8803 into the _time array
-// Needs to be called before printing time or date
-// We do not protect the GPx registers. They will be overwritten. The user has plenty of RAM if they need it.
-bool RV8803::updateTime()
+// Parses an ISO 8601 string (see setTime8601) into a BCD array laid out like _time, including the weekday.
+// Hundredths hold the first two digits of any fraction. Nothing is allocated and the RTC is not touched.
+bool RV8803::parseTime8601(const char* iso8601, uint8_t* time, int8_t &timeZoneQuarterHours, bool &hasTimeZone)
 {
-    if (readMultipleRegisters(RV8803_HUNDREDTHS, _time, TIME_ARRAY_LENGTH) == false)
-        return (false); // Something went wrong
+    const char* str = iso8601;
+    uint16_t year, month, date, hour, minute, second;
+    if (!parseDigits(str, 4, year) || !parseSeparator(str, '-') || !parseDigits(str, 2, month) || !parseSeparator(str, '-')
+        || !parseDigits(str, 2, date))
+        return false;
+    if ((*str != 'T') && (*str != 't') && (*str != ' '))
+        return false;
+    str++;
+    if (!parseDigits(str, 2, hour) || !parseSeparator(str, ':') || !parseDigits(str, 2, minute) || !parseSeparator(str, ':')
+        || !parseDigits(str, 2, second))
+        return false;
+    if ((year < 2000) || (year > 2099) || (month < 1) || (month > 12))
+        return false;
 
-    if (BCDtoDEC(_time[TIME_HUNDREDTHS]) == 99 || BCDtoDEC(_time[TIME_SECONDS]) == 59) // If hundredths are at 99 or seconds are at 59, read again to make sure we didn't accidentally skip a second/minute
+    uint8_t hundredths = 0;
+    if ((*str == '.') || (*str == ','))
     {
-        uint8_t tempTime[TIME_ARRAY_LENGTH];
-        if (readMultipleRegisters(RV8803_HUNDREDTHS, tempTime, TIME_ARRAY_LENGTH) == false) {
-            return (false); // Something went wrong
+        str++;
+        if ((*str < '0') || (*str > '9'))
+            return false; // A fraction needs at least one digit
+        for (uint8_t digits = 0; (*str >= '0') && (*str <= '9'); digits++, str++)
+        {
+            if (digits == 0)
+                hundredths = (*str - '0') * 10;
+            else if (digits == 1)
+                hundredths += (*str - '0');
+        }
+    }
+
+    hasTimeZone = false;
+    timeZoneQuarterHours = 0;
+    if ((*str == 'Z') || (*str == 'z'))
+    {
+        hasTimeZone = true;
+        str++;
+    }
+    else if ((*str == '+') || (*str == '-'))
+    {
+        bool negative = (*str++ == '-');
+        uint16_t tzHours, tzMinutes = 0;
+        if (!parseDigits(str, 2, tzHours))
+            return false;
+        if (*str == ':')
+        {
+            str++;
+            if (!parseDigits(str, 2, tzMinutes))
+                return false;
         }
-        if (BCDtoDEC(_time[TIME_HUNDREDTHS]) > BCDtoDEC(tempTime[TIME_HUNDREDTHS])) // If the reading for hundredths has rolled over, then our new data is correct, otherwise, we can leave the old data.
+        else if ((*str >= '0') && (*str <= '9'))
         {
-            memcpy(_time, tempTime, TIME_ARRAY_LENGTH);
+            if (!parseDigits(str, 2, tzMinutes))
+                return false;
         }
+        if ((tzMinutes % 15) != 0 || (tzMinutes > 45))
+            return false; // Has to fit in RV8803_RAM as quarter hours
+        int16_t quarterHours = (tzHours * 4) + (tzMinutes / 15);
+        if (quarterHours > 14 * 4)
+            return false; // No zone is further than 14 hours from UTC
+        timeZoneQuarterHours = negative ? -quarterHours : quarterHours;
+        hasTimeZone = true;
+    }
+    if (*str != '\0')
+        return false; // Trailing characters
+
+    time[TIME_HUNDREDTHS] = DECtoBCD(hundredths);
+    time[TIME_SECONDS] = DECtoBCD(second);
+    time[TIME_MINUTES] = DECtoBCD(minute);
+    time[TIME_HOURS] = DECtoBCD(hour);
+    time[TIME_WEEKDAY] = 1 << dayOfWeek(year, month, date);
+    time[TIME_DATE] = DECtoBCD(date);
+    time[TIME_MONTH] = DECtoBCD(month);
+    time[TIME_YEAR] = DECtoBCD(year - 2000);
+    return isValidTime(time); // Catches hour 24, minute 60, 31st April etc
+}
+
+// Sakamoto's method. Valid for any Gregorian date
+uint8_t RV8803::dayOfWeek(uint16_t year, uint8_t month, uint8_t date)
+{
+    static const uint8_t monthOffset[12] PROGMEM = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+    if (month < 3)
+        year--;
+    return (year + year / 4 - year / 100 + year / 400 + pgm_read_byte(&monthOffset[month - 1]) + date) % 7;
+}
+
+// Sets the RTC from the latest time parsed by an RV8803_NMEA. NMEA time is UTC, so it is moved into the
+// time zone stored in RV8803_RAM first, just like setEpoch().
+// Without a PPS pin the time is written straight away, with hundredths cleared. It will be behind by however
+// late the sentence arrived after the top of the second (typically a few hundred ms).
+// With a PPS pin the next second is written with the clock held in reset, and the clock is started on the
+// next rising edge of the pulse - which marks the start of that second. The sentence must be less than
+// 900ms old, otherwise we can't be sure which pulse comes next. CONTROL is read again after the edge, before the
+// write that starts the clock, which puts one short read (about 0.1ms at 400kHz) into the phase.
+bool RV8803::setTimeFromNMEA(const RV8803_NMEA &nmea, uint8_t ppsPin, uint16_t ppsTimeoutMillis)
+{
+    uint8_t time[TIME_ARRAY_LENGTH];
+    if (nmea.getTime(time) == false)
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
+    }
+    bool usePPS = (ppsPin != RV8803_NO_PIN);
+    if (usePPS && ((millis() - nmea.getTimeMillis()) > 900))
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false; // Too old to know which pulse is next
     }
-    return true;
-}
 
-uint8_t RV8803::getHundredths()
-{
-    return BCDtoDEC(_time[TIME_HUNDREDTHS]);
-}
+    int8_t quarterHours = getTimeZoneQuarterHours();
+    if (_lastError != RV8803_SUCCESS)
+        return false;
+    if (addSecondsToTime(time, ((int32_t)quarterHours * 15 * 60) + (usePPS ? 1 : 0)) == false)
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
+    }
 
-uint8_t RV8803::getSeconds()
-{
-    return BCDtoDEC(_time[TIME_SECONDS]);
+    // Like setTimePrecise(), the lock is only taken to stage and release the set, not while we wait for the pulse
+    if (stagePreciseSet(time) == false)
+        return false;
+
+    if (usePPS)
+    {
+        uint32_t startMillis = millis();
+        int previous = digitalRead(ppsPin);
+        while (true)
+        {
+            int current = digitalRead(ppsPin);
+            if ((previous == LOW) && (current == HIGH))
+                break; // Rising edge
+            previous = current;
+            if ((millis() - startMillis) > ppsTimeoutMillis)
+            {
+                releasePreciseSet(micros()); // Don't leave the clock stopped
+                _lastError = RV8803_ERROR_TIMEOUT;
+                return false;
+            }
+        }
+    }
+    return releasePreciseSet(micros());
 }
 
-uint8_t RV8803::getMinutes()
+bool RV8803::addSecondsToTime(uint8_t* time, int32_t seconds)
 {
-    return BCDtoDEC(_time[TIME_MINUTES]);
+    int32_t days = daysFromCivil(BCDtoDEC(time[TIME_YEAR]) + 2000, BCDtoDEC(time[TIME_MONTH]), BCDtoDEC(time[TIME_DATE]));
+    int32_t secondOfDay = (BCDtoDEC(time[TIME_HOURS]) * 3600L) + (BCDtoDEC(time[TIME_MINUTES]) * 60L) + BCDtoDEC(time[TIME_SECONDS]);
+
+    days += seconds / 86400L;
+    secondOfDay += seconds % 86400L;
+    if (secondOfDay < 0)
+    {
+        secondOfDay += 86400L;
+        days--;
+    }
+    else if (secondOfDay >= 86400L)
+    {
+        secondOfDay -= 86400L;
+        days++;
+    }
+    if ((days < 0) || (days >= 36525)) // 2000-01-01 to 2099-12-31
+        return false;
+
+    timeFromDays(time, days, secondOfDay);
+    return true;
 }
 
-uint8_t RV8803::getHours()
+// Writes only the fields selected by fieldMask (TIME_FIELD_SECONDS | TIME_FIELD_MINUTES etc.) from a BCD array
+// laid out like _time. Each run of adjacent fields is written in a single burst, so the other registers keep
+// counting and are never overwritten with stale values. Unlike setTime(), the RESET bit is not touched.
+bool RV8803::setTimeFields(uint8_t fieldMask, const uint8_t* time)
 {
-    uint8_t tempHours = BCDtoDEC(_time[TIME_HOURS]);
-    if (is12Hour()) {
-        if (tempHours > 12) {
-            tempHours -= 12;
+    BusLock lock(*this);
+    fieldMask &= TIME_FIELD_ALL; // Hundredths are read only
+
+    uint8_t first = TIME_SECONDS;
+    while (first < TIME_ARRAY_LENGTH)
+    {
+        if ((fieldMask & (1 << first)) == 0)
+        {
+            first++;
+            continue;
         }
+        uint8_t last = first;
+        while ((last + 1 < TIME_ARRAY_LENGTH) && (fieldMask & (1 << (last + 1))))
+            last++;
+
+        uint8_t len = last - first + 1;
+        if (tryWriteMultipleRegisters(RV8803_HUNDREDTHS + first, time + first, len) != RV8803_SUCCESS)
+            return false;
+        memcpy(&_time[first], &time[first], len); // Keep our copy in step with what the RTC now holds
+        first = last + 1;
     }
-    return tempHours;
+    if (fieldMask != 0)
+    {
+        _clockStepPending = true; // The other fields in _time may be stale, so re-base on the next snapshot instead
+        _timerStartKnown = false; // Noted in the old time
+    }
+    if (fieldMask & TIME_FIELD_SECONDS)
+        _tickSeconds = 0xFF; // The next update tick reads the seconds again
+    return true;
 }
 
-uint8_t RV8803::getDate()
+bool RV8803::setTimeField(uint8_t field, uint8_t bcdValue)
 {
-    return BCDtoDEC(_time[TIME_DATE]);
+    uint8_t time[TIME_ARRAY_LENGTH];
+    time[field] = bcdValue;
+    return setTimeFields(1 << field, time);
 }
 
-uint8_t RV8803::getWeekday()
+bool RV8803::setSeconds(uint8_t value)
 {
-    uint8_t tempWeekday = _time[TIME_WEEKDAY];
-    tempWeekday = log(tempWeekday) / log(2);
-    return tempWeekday;
+    return setTimeField(TIME_SECONDS, DECtoBCD(value));
 }
 
-uint8_t RV8803::getMonth()
+bool RV8803::setMinutes(uint8_t value)
 {
-    return BCDtoDEC(_time[TIME_MONTH]);
+    return setTimeField(TIME_MINUTES, DECtoBCD(value));
 }
 
-uint16_t RV8803::getYear()
+bool RV8803::setHours(uint8_t value)
 {
-    return BCDtoDEC(_time[TIME_YEAR]) + 2000;
+    return setTimeField(TIME_HOURS, DECtoBCD(value));
 }
 
-uint8_t RV8803::getHundredthsCapture()
+bool RV8803::setDate(uint8_t value)
 {
-    return BCDtoDEC(readRegister(RV8803_HUNDREDTHS_CAPTURE));
+    return setTimeField(TIME_DATE, DECtoBCD(value));
 }
 
-uint8_t RV8803::getSecondsCapture()
+bool RV8803::setMonth(uint8_t value)
 {
-    return BCDtoDEC(readRegister(RV8803_SECONDS_CAPTURE));
+    return setTimeField(TIME_MONTH, DECtoBCD(value));
 }
 
-// Takes the time from the last build and uses it as the current time
-// Works very well as an arduino sketch
-bool RV8803::setToCompilerTime()
+bool RV8803::setYear(uint16_t value)
 {
-    _time[TIME_SECONDS] = DECtoBCD(BUILD_SECOND);
-    _time[TIME_MINUTES] = DECtoBCD(BUILD_MINUTE);
-    _time[TIME_HOURS] = DECtoBCD(BUILD_HOUR);
+    return setTimeField(TIME_YEAR, DECtoBCD(value - 2000));
+}
 
-    _time[TIME_MONTH] = DECtoBCD(BUILD_MONTH);
-    _time[TIME_DATE] = DECtoBCD(BUILD_DATE);
-    _time[TIME_YEAR] = DECtoBCD(BUILD_YEAR - 2000); //! Not Y2K (or Y2.1K)-proof :(
+bool RV8803::setWeekday(uint8_t value) // value is anywhere between 0=sunday and 6=saturday
+{
+    if (value > 6) {
+        value = 6;
+    }
+    return setTimeField(TIME_WEEKDAY, 1 << value);
+}
 
-    // Calculate weekday (from here: http://stackoverflow.com/a/21235587)
-    // 0 = Sunday, 6 = Saturday
-    uint16_t d = BUILD_DATE;
-    uint16_t m = BUILD_MONTH;
-    uint16_t y = BUILD_YEAR;
-    uint16_t weekday = (d += m < 3 ? y-- : y - 2, 23 * m / 9 + d + 4 + y / 4 - y / 100 + y / 400) % 7;
-    _time[TIME_WEEKDAY] = 1 << weekday;
+// Move the hours, mins, sec, etc registers from RV-8803 into the _time array
+// Needs to be called before printing time or date
+// We do not protect the GPx registers. They will be overwritten. The user has plenty of RAM if they need it.
+//
+// The registers are read from hundredths upwards, so the only way the burst can straddle a carry is if
+// hundredths rolled from 99 to 00 while the later bytes were being read (the burst takes far less than 10ms).
+// So if we read anything other than 99 the snapshot is coherent and we're done with a single read.
+// If we read 99 we re-read just the hundredths byte: if it is still 99 nothing has rolled over since,
+// otherwise we read everything again, this time well clear of the boundary.
+//
+// A snapshot which fails isValidTime() (e.g. all 0xFF after a bus glitch) is read again. _time is only
+// updated with a valid snapshot.
+//
+// With enableTimeValidityTracking() the burst carries on up to the flag register (15 bytes instead of 8)
+// so the supply flags are checked on every read without another transaction.
+bool RV8803::updateTime()
+{
+    BusLock lock(*this);
+    _timeStale = true; // Until this read succeeds
+    uint8_t snapshot[RV8803_SNAPSHOT_WITH_FLAGS_LENGTH];
+    if (readSnapshot(snapshot, _trackValidity ? RV8803_SNAPSHOT_WITH_FLAGS_LENGTH : TIME_ARRAY_LENGTH) == false)
+        return false;
+
+    memcpy(_time, snapshot, TIME_ARRAY_LENGTH);
+    _timeStale = false;
+    noteClock(_time, _clockStepPending);
+    if (_trackValidity)
+        noteSupplyFlags(snapshot[RV8803_FLAG - RV8803_HUNDREDTHS]);
+    if (_validity == RV8803_TIME_TRUSTED)
+        memcpy(_lastTrustedTime, _time, TIME_ARRAY_LENGTH);
+    return true;
+}
+
+// For callers which keep their own copy of the time, such as RV8803_Clock: the same snapshot as updateTime() and
+// the time zone under one lock, without changing the time the getters return
+bool RV8803::readTime(uint8_t* time, int8_t &quarterHours)
+{
+    BusLock lock(*this);
+    if (readSnapshot(time, TIME_ARRAY_LENGTH) == false)
+        return false;
+    quarterHours = getTimeZoneQuarterHours();
+    return _lastError == RV8803_SUCCESS;
+}
+
+// Burst reads len bytes from RV8803_HUNDREDTHS, again if the hundredths rolled over part way through, and again
+// if the time is corrupt
+bool RV8803::readSnapshot(uint8_t* snapshot, uint8_t len)
+{
+    BusLock lock(*this);
+    _snapshotReads++;
+    for (uint8_t attempt = 0; attempt < RV8803_SNAPSHOT_READ_ATTEMPTS; attempt++)
+    {
+        if (readMultipleRegisters(RV8803_HUNDREDTHS, snapshot, len) == false)
+            return (false); // Something went wrong
+
+        if (snapshot[TIME_HUNDREDTHS] == 0x99)
+        {
+            uint8_t hundredths;
+            if (tryReadRegister(RV8803_HUNDREDTHS, hundredths) != RV8803_SUCCESS)
+                return (false);
+            if (hundredths != 0x99) // Rolled over, possibly part way through the burst
+            {
+                _snapshotRetries++;
+                if (readMultipleRegisters(RV8803_HUNDREDTHS, snapshot, len) == false)
+                    return (false);
+            }
+        }
+
+        if (isValidTime(snapshot))
+            return true;
+        _rejectedSnapshots++;
+    }
+    return false; // Every read was corrupt
+}
+
+/*********************************
+Time validity tracking
+V1F is set when the supply dropped low enough to stop temperature compensation, V2F when it dropped low enough
+that the time data may be lost. Once either is seen the state only gets worse, until the time is set again
+through the library (setTime, setEpoch, setTimePrecise etc.), which clears both flags and makes it trusted.
+*********************************/
+void RV8803::enableTimeValidityTracking(bool enable)
+{
+    _trackValidity = enable;
+}
+
+bool RV8803::checkTimeValidity()
+{
+    uint8_t flags;
+    if (tryReadRegister(RV8803_FLAG, flags) != RV8803_SUCCESS)
+        return false;
+    noteSupplyFlags(flags);
+    return true;
+}
+
+RV8803_TimeValidity RV8803::getTimeValidity()
+{
+    return _validity;
+}
 
+bool RV8803::getValidEpoch(uint32_t &epoch, bool use1970sEpoch)
+{
+    if (_validity == RV8803_TIME_INVALID)
+        return false;
+    epoch = getEpoch(use1970sEpoch);
+    return (_lastError == RV8803_SUCCESS); // getEpoch reads the time zone
+}
+
+uint32_t RV8803::getLastTrustedEpoch(bool use1970sEpoch)
+{
+    if (_lastTrustedTime[TIME_MONTH] == 0)
+        return 0; // Never been trusted
+    return epochFromTime(_lastTrustedTime, use1970sEpoch);
+}
+
+void RV8803::noteSupplyFlags(uint8_t flags)
+{
+    RV8803_TimeValidity seen = RV8803_TIME_TRUSTED;
+    if (flags & (1 << FLAG_V2F))
+        seen = RV8803_TIME_INVALID;
+    else if (flags & (1 << FLAG_V1F))
+        seen = RV8803_TIME_DEGRADED;
+
+    if ((_validityChecked == false) || (seen < _validity))
+        _validity = seen; // The first check sets the state, after that it can only get worse
+    _validityChecked = true;
+}
+
+// Called after a full time set: the supply flags and the update tick count no longer apply to the new time
+bool RV8803::markTimeSet()
+{
+    _tickSeconds = 0xFF; // The next update tick reads the seconds again
+    _timerStartKnown = false; // Noted in the old time
+    if (clearInterruptFlags((1 << FLAG_V1F) | (1 << FLAG_V2F)) == false)
+        return false;
+    _validity = RV8803_TIME_TRUSTED;
+    _validityChecked = true;
+    return true;
+}
+
+// One bit per byte value, set if both nibbles are 0-9
+static const uint8_t validBCD[32] PROGMEM = {
+    0xFF, 0x03, 0xFF, 0x03, 0xFF, 0x03, 0xFF, 0x03, 0xFF, 0x03,
+    0xFF, 0x03, 0xFF, 0x03, 0xFF, 0x03, 0xFF, 0x03, 0xFF, 0x03,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+// Largest legal BCD value of each field in time_order. The weekday is one-hot and checked separately
+static const uint8_t maxBCD[TIME_ARRAY_LENGTH] PROGMEM = { 0x99, 0x59, 0x59, 0x23, 0x00, 0x31, 0x12, 0x99 };
+
+// Days in each month, in BCD so it can be compared with the date register directly
+static const uint8_t daysInMonthBCD[12] PROGMEM = { 0x31, 0x29, 0x31, 0x30, 0x31, 0x30, 0x31, 0x31, 0x30, 0x31, 0x30, 0x31 };
+
+// Returns true if the snapshot could have come from a healthy RV-8803
+bool RV8803::isValidTime(const uint8_t* time)
+{
+    for (uint8_t i = 0; i < TIME_ARRAY_LENGTH; i++)
+    {
+        if (i == TIME_WEEKDAY)
+            continue;
+        uint8_t val = time[i];
+        if ((pgm_read_byte(&validBCD[val >> 3]) & (1 << (val & 0x07))) == 0)
+            return false; // Not BCD
+        if (val > pgm_read_byte(&maxBCD[i]))
+            return false; // BCD values compare correctly as plain bytes
+    }
+
+    uint8_t weekday = time[TIME_WEEKDAY];
+    if ((weekday == 0) || (weekday > SATURDAY) || ((weekday & (weekday - 1)) != 0))
+        return false; // Exactly one of the seven weekday bits must be set
+
+    uint8_t month = time[TIME_MONTH];
+    uint8_t date = time[TIME_DATE];
+    if ((month == 0) || (date == 0))
+        return false;
+    uint8_t lastDay = pgm_read_byte(&daysInMonthBCD[BCDtoDEC(month) - 1]);
+    if ((month == 0x02) && ((BCDtoDEC(time[TIME_YEAR]) % 4) != 0))
+        lastDay = 0x28; // Every year divisible by 4 from 2000 to 2099 is a leap year
+    return (date <= lastDay);
+}
+
+uint32_t RV8803::getRejectedSnapshotCount()
+{
+    return _rejectedSnapshots;
+}
+
+// Number of times updateTime() has been called
+uint32_t RV8803::getSnapshotCount()
+{
+    return _snapshotReads;
+}
+
+// Number of updateTime() reads that straddled a hundredths rollover and had to be read again
+uint32_t RV8803::getSnapshotRetryCount()
+{
+    return _snapshotRetries;
+}
+
+uint8_t RV8803::getHundredths()
+{
+    return BCDtoDEC(_time[TIME_HUNDREDTHS]);
+}
+
+uint8_t RV8803::getSeconds()
+{
+    return BCDtoDEC(_time[TIME_SECONDS]);
+}
+
+uint8_t RV8803::getMinutes()
+{
+    return BCDtoDEC(_time[TIME_MINUTES]);
+}
+
+uint8_t RV8803::getHours()
+{
+    uint8_t tempHours = BCDtoDEC(_time[TIME_HOURS]);
+    if (is12Hour()) {
+        if (tempHours > 12) {
+            tempHours -= 12;
+        }
+    }
+    return tempHours;
+}
+
+uint8_t RV8803::getDate()
+{
+    return BCDtoDEC(_time[TIME_DATE]);
+}
+
+uint8_t RV8803::getWeekday()
+{
+    // The weekday register is one-hot, so the weekday is the position of the set bit
+    uint8_t tempWeekday = 0;
+    for (uint8_t bits = _time[TIME_WEEKDAY] & 0x7F; bits > 1; bits >>= 1)
+        tempWeekday++;
+    return tempWeekday;
+}
+
+uint8_t RV8803::getMonth()
+{
+    return BCDtoDEC(_time[TIME_MONTH]);
+}
+
+uint16_t RV8803::getYear()
+{
+    return BCDtoDEC(_time[TIME_YEAR]) + 2000;
+}
+
+uint8_t RV8803::getHundredthsCapture()
+{
+    return BCDtoDEC(readRegister(RV8803_HUNDREDTHS_CAPTURE));
+}
+
+uint8_t RV8803::getSecondsCapture()
+{
+    return BCDtoDEC(readRegister(RV8803_SECONDS_CAPTURE));
+}
+
+// Takes the time from the last build and uses it as the current time
+// Works very well as an arduino sketch
+// The register image is worked out by the compiler, so this is just one burst write
+bool RV8803::setToCompilerTime()
+{
+    memcpy(_time, compilerTime, TIME_ARRAY_LENGTH);
     return setTime(_time, TIME_ARRAY_LENGTH);
 }
 
+// Seconds since 1970-01-01 of the time setToCompilerTime() writes (local time, no time zone subtracted)
+uint32_t RV8803::getCompilerEpoch()
+{
+    return COMPILER_EPOCH;
+}
+
+// The offset is a 6 bit two's complement value, 0.2384 ppm (238.4 ppb) per step
+#define OFFSET_STEP_TENTHS_PPB	2384L // long, so the products below don't overflow a 16 bit int
+#define OFFSET_MIN_STEPS		-32
+#define OFFSET_MAX_STEPS		31
+
+// Anything from here to here rounds to a step in range
+static const int32_t offsetMinPPB = ((OFFSET_MIN_STEPS * OFFSET_STEP_TENTHS_PPB) - (OFFSET_STEP_TENTHS_PPB / 2)) / 10;
+static const int32_t offsetMaxPPB = ((OFFSET_MAX_STEPS * OFFSET_STEP_TENTHS_PPB) + (OFFSET_STEP_TENTHS_PPB / 2)) / 10;
+
+static int8_t offsetSteps(uint8_t offsetRegister)
+{
+    int8_t steps = offsetRegister & 0x3F;
+    if (steps >= 32)
+        steps -= 64;
+    return steps;
+}
+
+#ifndef RV8803_NO_FLOAT
 bool RV8803::setCalibrationOffset(float ppm)
 {
-    int8_t integerOffset = ppm / 0.2384; //.2384 is ppm/LSB
-    if (integerOffset < 0) {
-        integerOffset += 64;
-    }
-    return writeRegister(RV8803_OFFSET, integerOffset);
+    return setCalibrationOffsetPPB(lround(ppm * 1000));
 }
 
 float RV8803::getCalibrationOffset()
 {
-    int8_t value = readRegister(RV8803_OFFSET);
-    if (value > 32) {
-        value -= 64;
+    return offsetSteps(readRegister(RV8803_OFFSET)) * .2384;
+}
+#endif
+
+bool RV8803::setCalibrationOffsetPPB(int32_t ppb)
+{
+    // Round half away from zero. Check the range first so ppb * 10 can't overflow
+    if ((ppb < offsetMinPPB) || (ppb > offsetMaxPPB))
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
+    }
+    int32_t tenths = ppb * 10;
+    int8_t steps = (tenths + ((tenths < 0) ? -(OFFSET_STEP_TENTHS_PPB / 2) : (OFFSET_STEP_TENTHS_PPB / 2))) / OFFSET_STEP_TENTHS_PPB;
+    if ((steps < OFFSET_MIN_STEPS) || (steps > OFFSET_MAX_STEPS))
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
     }
-    return value * .2384;
+    return writeRegister(RV8803_OFFSET, steps & 0x3F);
+}
+
+int32_t RV8803::getCalibrationOffsetPPB()
+{
+    int32_t tenths = (int32_t)offsetSteps(readRegister(RV8803_OFFSET)) * OFFSET_STEP_TENTHS_PPB;
+    return (tenths + ((tenths < 0) ? -5 : 5)) / 10;
+}
+
+/*********************************
+Slewing
+A correction of C ms at a rate of R ppm takes C / R seconds, e.g. 100ms at the full 63 steps (15 ppm) is
+about 1.8 hours. The OFFSET register is at its limit (-32 to speed up, +31 to slow down) for the whole time,
+so the further the calibration already is from that limit, the faster the slew.
+*********************************/
+bool RV8803::startSlew(int32_t correctionMillis)
+{
+    BusLock lock(*this);
+    if (_slewing && (stopSlew() == false))
+        return false;
+    if (correctionMillis == 0)
+        return true;
+
+    uint8_t baseline;
+    if (tryReadRegister(RV8803_OFFSET, baseline) != RV8803_SUCCESS)
+        return false;
+    baseline &= 0x3F;
+
+    // Increasing the offset slows the clock
+    int8_t target = (correctionMillis > 0) ? OFFSET_MIN_STEPS : OFFSET_MAX_STEPS;
+    uint8_t rateSteps = abs(target - offsetSteps(baseline));
+    if (rateSteps == 0)
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT; // Already at the limit
+        return false;
+    }
+    uint32_t magnitude = (correctionMillis > 0) ? correctionMillis : -(uint32_t)correctionMillis;
+    uint64_t duration = ((uint64_t)magnitude * 10000000000ULL) / ((uint32_t)rateSteps * OFFSET_STEP_TENTHS_PPB); // The rate is rateSteps * 2384 parts in 1e10
+    if (duration > 0xFFFFFFFFULL)
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT; // It would take longer than millis() can count
+        return false;
+    }
+
+    if (tryWriteRegister(RV8803_OFFSET, target & 0x3F) != RV8803_SUCCESS)
+        return false;
+    _slewBaseline = baseline;
+    _slewCorrectionMillis = correctionMillis;
+    _slewDurationMillis = duration;
+    _slewElapsedMillis = 0;
+    _slewLastMillis = millis();
+    _slewing = true;
+    return true;
+}
+
+bool RV8803::serviceSlew()
+{
+    if (_slewing == false)
+        return true;
+    uint32_t now = millis();
+    uint32_t delta = now - _slewLastMillis;
+    _slewLastMillis = now;
+    _slewElapsedMillis = (delta > (_slewDurationMillis - _slewElapsedMillis)) ? _slewDurationMillis : _slewElapsedMillis + delta;
+    if (_slewElapsedMillis < _slewDurationMillis)
+        return true;
+    return stopSlew();
+}
+
+bool RV8803::stopSlew()
+{
+    if (_slewing == false)
+        return true;
+    if (tryWriteRegister(RV8803_OFFSET, _slewBaseline) != RV8803_SUCCESS)
+        return false; // Still slewing. Try again later
+    uint32_t delta = millis() - _slewLastMillis;
+    _slewElapsedMillis = (delta > (_slewDurationMillis - _slewElapsedMillis)) ? _slewDurationMillis : _slewElapsedMillis + delta;
+    _slewing = false;
+    return true;
+}
+
+bool RV8803::isSlewing()
+{
+    return _slewing;
+}
+
+uint32_t RV8803::getSlewDurationMillis()
+{
+    return _slewDurationMillis;
+}
+
+uint32_t RV8803::getSlewRemainingMillis()
+{
+    if (_slewing == false)
+        return 0;
+    uint32_t elapsed = _slewElapsedMillis + (millis() - _slewLastMillis);
+    return (elapsed >= _slewDurationMillis) ? 0 : _slewDurationMillis - elapsed;
+}
+
+int32_t RV8803::getSlewRemainingCorrectionMillis()
+{
+    if (_slewDurationMillis == 0)
+        return 0;
+    uint32_t remaining = _slewing ? getSlewRemainingMillis() : _slewDurationMillis - _slewElapsedMillis;
+    return ((int64_t)_slewCorrectionMillis * remaining) / _slewDurationMillis;
 }
 
 bool RV8803::setEVIDebounceTime(uint8_t debounceTime)
@@ -830,9 +1545,25 @@ bool RV8803::getEVIEventCapture()
     return readBit(RV8803_EVENT_CONTROL, EVENT_ECP);
 }
 
+// The timer starts counting from its preset when TE goes from 0 to 1, so note the time then: reading the
+// timer registers back only gives the preset, never the count.
 bool RV8803::setCountdownTimerEnable(bool timerState)
 {
-    return writeBit(RV8803_EXTENSION, EXTENSION_TE, timerState);
+    if (timerState == false)
+        return writeBit(RV8803_EXTENSION, EXTENSION_TE, false);
+
+    BusLock lock(*this);
+    uint8_t regs[RV8803_EXTENSION - RV8803_HUNDREDTHS + 1]; // The time and EXTENSION in one burst
+    if (tryReadMultipleRegisters(RV8803_HUNDREDTHS, regs, sizeof(regs)) != RV8803_SUCCESS)
+        return false;
+    uint8_t extension = regs[RV8803_EXTENSION - RV8803_HUNDREDTHS];
+    if (extension & (1 << EXTENSION_TE))
+        return true; // Already running, from whenever it was started
+    if (tryWriteRegister(RV8803_EXTENSION, extension | (1 << EXTENSION_TE)) != RV8803_SUCCESS)
+        return false;
+    _timerStartKnown = isValidTime(regs);
+    _timerStartMillis = millisFromTime(regs);
+    return true;
 }
 
 bool RV8803::setCountdownTimerFrequency(uint8_t countdownTimerFrequency)
@@ -842,14 +1573,15 @@ bool RV8803::setCountdownTimerFrequency(uint8_t countdownTimerFrequency)
 
 bool RV8803::setCountdownTimerClockTicks(uint16_t clockTicks)
 {
+    BusLock lock(*this);
     // First handle the upper bit, as we need to preserve the GPX bits
-    uint8_t value = readRegister(RV8803_TIMER_1);
-    value &= ~(0b00001111); // Clear the least significant nibble
-    value |= (clockTicks >> 8);
-    bool returnValue = writeRegister(RV8803_TIMER_1, value);
-    value = clockTicks & 0x00FF;
-    returnValue &= writeRegister(RV8803_TIMER_0, value);
-    return returnValue;
+    uint8_t value;
+    if (tryReadRegister(RV8803_TIMER_1, value) != RV8803_SUCCESS)
+        return false;
+    uint8_t values[2];
+    values[0] = clockTicks & 0x00FF;
+    values[1] = (value & ~(0b00001111)) | ((clockTicks >> 8) & 0b00001111); // Keep the GPX bits in the upper nibble
+    return tryWriteMultipleRegisters(RV8803_TIMER_0, values, 2) == RV8803_SUCCESS;
 }
 
 bool RV8803::setClockOutTimerFrequency(uint8_t clockOutTimerFrequency)
@@ -867,11 +1599,81 @@ uint8_t RV8803::getCountdownTimerFrequency()
     return readTwoBits(RV8803_EXTENSION, EXTENSION_TD);
 }
 
+// TIMER_0 and TIMER_1 read back the preset, not the count, so one burst is coherent whether the timer runs or not
 uint16_t RV8803::getCountdownTimerClockTicks()
 {
-    uint16_t value = readRegister(RV8803_TIMER_1) << 8;
-    value |= readRegister(RV8803_TIMER_0);
-    return value;
+    uint8_t regs[2];
+    if (tryReadMultipleRegisters(RV8803_TIMER_0, regs, sizeof(regs)) != RV8803_SUCCESS)
+        return 0;
+    return ((regs[1] & 0x0F) << 8) | regs[0]; // The upper nibble of TIMER_1 is GPX
+}
+
+// The time left comes from when setCountdownTimerEnable() started the timer, as the RTC can't tell us. The timer
+// reloads its preset every time it fires. The 4096 Hz and 64 Hz timer clocks run freely, so each period is simply
+// ticks timer clock periods. The 1 Hz and 1/60 Hz timer clocks tick with the seconds and minutes, so the first
+// period ends ticks - 1 seconds or minutes after the first whole second or minute after the start.
+// time is a burst from RV8803_HUNDREDTHS to RV8803_EXTENSION
+bool RV8803::countdownRemainingMillis(const uint8_t* time, uint32_t &remainingMillis)
+{
+    uint8_t extension = time[RV8803_EXTENSION - RV8803_HUNDREDTHS];
+    uint16_t ticks = ((time[RV8803_TIMER_1 - RV8803_HUNDREDTHS] & 0x0F) << 8) | time[RV8803_TIMER_0 - RV8803_HUNDREDTHS];
+    if (((extension & (1 << EXTENSION_TE)) == 0) || (ticks == 0) || (_timerStartKnown == false) || (isValidTime(time) == false))
+        return false;
+
+    int64_t startMicros = _timerStartMillis * 1000;
+    int64_t firstMicros; // When it first fires
+    uint64_t periodMicros;
+    switch ((extension >> EXTENSION_TD) & 0b11)
+    {
+    case COUNTDOWN_TIMER_FREQUENCY_4096_HZ:
+        periodMicros = ((uint64_t)ticks * 1000000) / 4096;
+        firstMicros = startMicros + periodMicros;
+        break;
+    case COUNTDOWN_TIMER_FREQUENCY_64_HZ:
+        periodMicros = ((uint64_t)ticks * 1000000) / 64;
+        firstMicros = startMicros + periodMicros;
+        break;
+    case COUNTDOWN_TIMER_FREQUENCY_1_HZ:
+        periodMicros = (uint64_t)ticks * 1000000;
+        firstMicros = (((startMicros / 1000000) + ticks) * 1000000);
+        break;
+    default: // COUNTDOWN_TIMER_FREQUENCY_1_60TH_HZ
+        periodMicros = (uint64_t)ticks * 60000000;
+        firstMicros = (((startMicros / 60000000) + ticks) * 60000000);
+        break;
+    }
+
+    int64_t nowMicros = millisFromTime(time) * 1000;
+    uint64_t remainingMicros;
+    if (nowMicros < firstMicros)
+        remainingMicros = firstMicros - nowMicros;
+    else
+        remainingMicros = periodMicros - ((uint64_t)(nowMicros - firstMicros) % periodMicros);
+    remainingMillis = (uint32_t)((remainingMicros + 999) / 1000);
+    return true;
+}
+
+bool RV8803::getCountdownTimerRemainingMillis(uint32_t &remainingMillis)
+{
+    uint8_t regs[RV8803_EXTENSION - RV8803_HUNDREDTHS + 1]; // The time, alarm and timer registers and EXTENSION in one burst
+    if (tryReadMultipleRegisters(RV8803_HUNDREDTHS, regs, sizeof(regs)) != RV8803_SUCCESS)
+        return false;
+    return countdownRemainingMillis(regs, remainingMillis);
+}
+
+bool RV8803::getCountdownTimerExpiryEpoch(uint32_t &epoch)
+{
+    BusLock lock(*this);
+    uint8_t regs[RV8803_EXTENSION - RV8803_HUNDREDTHS + 1];
+    uint32_t remainingMillis;
+    if ((tryReadMultipleRegisters(RV8803_HUNDREDTHS, regs, sizeof(regs)) != RV8803_SUCCESS) || (countdownRemainingMillis(regs, remainingMillis) == false))
+        return false;
+
+    uint32_t now = epochFromTime(regs, true); // Reads the time zone
+    if (_lastError != RV8803_SUCCESS)
+        return false;
+    epoch = now + ((BCDtoDEC(regs[TIME_HUNDREDTHS]) * 10 + remainingMillis + 500) / 1000);
+    return true;
 }
 
 uint8_t RV8803::getClockOutTimerFrequency()
@@ -881,12 +1683,113 @@ uint8_t RV8803::getClockOutTimerFrequency()
 
 bool RV8803::setPeriodicTimeUpdateFrequency(bool timeUpdateFrequency)
 {
-    return writeBit(RV8803_EXTENSION, EXTENSION_USEL, timeUpdateFrequency);
+    bool response = writeBit(RV8803_EXTENSION, EXTENSION_USEL, timeUpdateFrequency);
+    _updateFrequency = response ? timeUpdateFrequency : 0xFF;
+    return response;
 }
 
 bool RV8803::getPeriodicTimeUpdateFrequency()
 {
-    return readBit(RV8803_EXTENSION, EXTENSION_USEL);
+    bool frequency = readBit(RV8803_EXTENSION, EXTENSION_USEL);
+    if (_lastError == RV8803_SUCCESS)
+        _updateFrequency = frequency;
+    return frequency;
+}
+
+/*********************************
+Second and minute subscriptions
+The UPDATE flag is set on every second (or minute) boundary. serviceTimeUpdates() reads the flag register
+once, and only if the flag is set does it clear it and call the subscribers. Call it from loop() or after
+the INT pin fires (enableHardwareInterrupt(UPDATE_INTERRUPT)).
+The time itself is not read: a subscriber that needs it calls updateTime().
+If serviceTimeUpdates() is called less than once per tick, the missed ticks are lost. In 1 second mode a
+missed tick delays the next minute callback, by up to the number of ticks missed since the one before. If 30
+or more are missed in one minute, the rollover can't be told from the clock being set back, and isn't reported.
+*********************************/
+void RV8803::onSecond(RV8803_TickCallback callback)
+{
+    _onSecond = callback;
+    if ((callback != nullptr) && (_updateFrequency != TIME_UPDATE_1_SECOND))
+        setPeriodicTimeUpdateFrequency(TIME_UPDATE_1_SECOND);
+}
+
+void RV8803::onMinute(RV8803_TickCallback callback)
+{
+    _onMinute = callback;
+}
+
+bool RV8803::serviceTimeUpdates()
+{
+    bool second, minute;
+    {
+        BusLock lock(*this); // Not held while the subscribers run, so they can use the bus and so can other tasks
+        uint8_t flags;
+        if (tryReadRegister(RV8803_FLAG, flags) != RV8803_SUCCESS)
+            return false;
+        noteSupplyFlags(flags);
+        if ((flags & (1 << FLAG_UPDATE)) == 0)
+            return false; // No tick since last time
+
+        clearInterruptFlag(FLAG_UPDATE); // Leaves any other flags alone
+        countTimeUpdate(second, minute);
+    }
+    dispatchTimeUpdate(second, minute);
+    return true;
+}
+
+// Work out which boundary the tick was: second is true in 1 second mode, minute if the tick was a minute.
+// Call with the bus lock held
+void RV8803::countTimeUpdate(bool &second, bool &minute)
+{
+    if (_updateFrequency == 0xFF)
+        getPeriodicTimeUpdateFrequency(); // Only needed once
+
+    second = false;
+    minute = false;
+    if (_updateFrequency == TIME_UPDATE_1_MINUTE)
+    {
+        _tickSeconds = 0;
+        minute = true;
+        return;
+    }
+    second = true;
+
+    // In 1 second mode the minute is found by counting the ticks. Missed ticks leave the count behind, so the RTC
+    // is read at the tick we expect to be second 59 (one single byte read a minute). Below 30 there means the minute
+    // has already rolled over: it is reported at once, late, and the count is back in step.
+    // The count is only ever seeded here, at a tick: a snapshot from updateTime() can't be used, as a tick may
+    // already be pending when it is taken, and counting on from it would then be one second ahead
+    if (_onMinute != nullptr)
+    {
+        uint8_t expected = (_tickSeconds >= 60) ? 0xFF : (_tickSeconds + 1) % 60; // 0xFF = not known yet
+        if ((expected == 0xFF) || (expected == 59))
+        {
+            uint8_t seconds;
+            if (tryReadRegister(RV8803_SECONDS, seconds) == RV8803_SUCCESS)
+            {
+                _tickSeconds = BCDtoDEC(seconds);
+                minute = (_tickSeconds == 0) || ((expected == 59) && (_tickSeconds < 30));
+            }
+            else
+                _tickSeconds = expected; // Try again next minute
+        }
+        else
+        {
+            _tickSeconds = expected;
+            minute = (_tickSeconds == 0);
+        }
+    }
+}
+
+// Call the subscribers for a tick counted by countTimeUpdate(), without the bus lock
+void RV8803::dispatchTimeUpdate(bool second, bool minute)
+{
+    RV8803_TickCallback onSecond = _onSecond;
+    RV8803_TickCallback onMinute = _onMinute;
+    if (second && (onSecond != nullptr))
+        onSecond();
+    if (minute && (onMinute != nullptr))
+        onMinute();
 }
 
 /********************************
@@ -894,21 +1797,26 @@ Set Alarm Mode controls which parts of the time have to match for the alarm to t
 When the RTC matches a given time, make an interrupt fire.
 Setting a bit to 1 means that the RTC does not check if that value matches to trigger the alarm
 ********************************/
-void RV8803::setItemsToMatchForAlarm(bool minuteAlarm, bool hourAlarm, bool weekdayAlarm, bool dateAlarm)
+bool RV8803::setItemsToMatchForAlarm(bool minuteAlarm, bool hourAlarm, bool weekdayAlarm, bool dateAlarm)
 {
-    writeBit(RV8803_MINUTES_ALARM, ALARM_ENABLE, !minuteAlarm); // For some reason these bits are active low
-    writeBit(RV8803_HOURS_ALARM, ALARM_ENABLE, !hourAlarm);
-    writeBit(RV8803_WEEKDAYS_DATE_ALARM, ALARM_ENABLE, !weekdayAlarm);
-    writeBit(RV8803_EXTENSION, EXTENSION_WADA, dateAlarm);
+    BusLock lock(*this);
+    bool response = writeBit(RV8803_MINUTES_ALARM, ALARM_ENABLE, !minuteAlarm); // For some reason these bits are active low
+    response &= writeBit(RV8803_HOURS_ALARM, ALARM_ENABLE, !hourAlarm);
+    response &= writeBit(RV8803_WEEKDAYS_DATE_ALARM, ALARM_ENABLE, !weekdayAlarm);
+    response &= writeBit(RV8803_EXTENSION, EXTENSION_WADA, dateAlarm);
     if (dateAlarm == true) // enabling both weekday and date alarm will default to a date alarm
     {
-        writeBit(RV8803_WEEKDAYS_DATE_ALARM, ALARM_ENABLE, !dateAlarm);
+        response &= writeBit(RV8803_WEEKDAYS_DATE_ALARM, ALARM_ENABLE, !dateAlarm);
     }
+    return response;
 }
 
 bool RV8803::setAlarmMinutes(uint8_t minute)
 {
-    uint8_t value = readRegister(RV8803_MINUTES_ALARM);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(RV8803_MINUTES_ALARM, value) != RV8803_SUCCESS)
+        return false;
     value &= (1 << ALARM_ENABLE); // clear everything but enable bit
     value |= DECtoBCD(minute);
     return writeRegister(RV8803_MINUTES_ALARM, value);
@@ -916,7 +1824,10 @@ bool RV8803::setAlarmMinutes(uint8_t minute)
 
 bool RV8803::setAlarmHours(uint8_t hour)
 {
-    uint8_t value = readRegister(RV8803_HOURS_ALARM);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(RV8803_HOURS_ALARM, value) != RV8803_SUCCESS)
+        return false;
     value &= (1 << ALARM_ENABLE); // clear everything but enable bit
     value |= DECtoBCD(hour);
     return writeRegister(RV8803_HOURS_ALARM, value);
@@ -924,7 +1835,10 @@ bool RV8803::setAlarmHours(uint8_t hour)
 
 bool RV8803::setAlarmWeekday(uint8_t weekday)
 {
-    uint8_t value = readRegister(RV8803_WEEKDAYS_DATE_ALARM);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(RV8803_WEEKDAYS_DATE_ALARM, value) != RV8803_SUCCESS)
+        return false;
     value &= (1 << ALARM_ENABLE); // clear everything but enable bit
     value |= 0x7F & weekday;
     return writeRegister(RV8803_WEEKDAYS_DATE_ALARM, value);
@@ -932,7 +1846,10 @@ bool RV8803::setAlarmWeekday(uint8_t weekday)
 
 bool RV8803::setAlarmDate(uint8_t date)
 {
-    uint8_t value = readRegister(RV8803_WEEKDAYS_DATE_ALARM);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(RV8803_WEEKDAYS_DATE_ALARM, value) != RV8803_SUCCESS)
+        return false;
     value &= (1 << ALARM_ENABLE); // clear everything but enable bit
     value |= DECtoBCD(date);
     return writeRegister(RV8803_WEEKDAYS_DATE_ALARM, value);
@@ -958,6 +1875,84 @@ uint8_t RV8803::getAlarmDate()
     return BCDtoDEC(readRegister(RV8803_WEEKDAYS_DATE_ALARM));
 }
 
+// Earliest minute of the day at or after fromMinute which matches the alarm hour and minute (-1 = any). -1 if none
+static int16_t firstAlarmMinuteOfDay(int16_t fromMinute, int8_t hour, int8_t minute)
+{
+    for (int16_t h = fromMinute / 60; h < 24; h++)
+    {
+        if ((hour >= 0) && (h != hour))
+            continue;
+        int16_t earliest = (h == fromMinute / 60) ? fromMinute % 60 : 0;
+        if (minute < 0)
+            return (h * 60) + earliest;
+        if (minute >= earliest)
+            return (h * 60) + minute;
+    }
+    return -1;
+}
+
+// The alarm goes off at second 00 of the first minute where every enabled field matches (enable bits are active low).
+// The weekday field is a mask of days when WADA is 0, or a date when WADA is 1. Starting from the time read by the
+// last updateTime(), step through the days until one matches, then find the first matching minute in that day.
+// One burst read covers RAM (the time zone), the three alarm registers and EXTENSION (WADA).
+// Without a good snapshot to start from (no updateTime() yet, or the last one failed) there is no answer.
+bool RV8803::getNextAlarmEpoch(uint32_t &epoch)
+{
+    if (_timeStale || (isValidTime(_time) == false))
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
+    }
+    uint8_t regs[RV8803_EXTENSION - RV8803_MINUTES_ALARM + 2];
+    if (tryReadMultipleRegisters(RV8803_RAM, regs, sizeof(regs)) != RV8803_SUCCESS) // RAM, then the lower mirror of 0x18 - 0x1D
+        return false;
+    int8_t quarterHours = (int8_t)regs[0];
+    uint8_t minuteAlarm = regs[1 + RV8803_MINUTES_ALARM - RV8803_MINUTES_ALARM];
+    uint8_t hourAlarm = regs[1 + RV8803_HOURS_ALARM - RV8803_MINUTES_ALARM];
+    uint8_t dayAlarm = regs[1 + RV8803_WEEKDAYS_DATE_ALARM - RV8803_MINUTES_ALARM];
+    bool dateMode = regs[1 + RV8803_EXTENSION - RV8803_MINUTES_ALARM] & (1 << EXTENSION_WADA);
+
+    bool minuteEnabled = !(minuteAlarm & (1 << ALARM_ENABLE));
+    bool hourEnabled = !(hourAlarm & (1 << ALARM_ENABLE));
+    bool dayEnabled = !(dayAlarm & (1 << ALARM_ENABLE));
+    if (!minuteEnabled && !hourEnabled && !dayEnabled)
+        return false; // Alarm disabled
+    int8_t minute = minuteEnabled ? BCDtoDEC(minuteAlarm & 0x7F) : -1;
+    int8_t hour = hourEnabled ? BCDtoDEC(hourAlarm & 0x3F) : -1;
+    if ((minute > 59) || (hour > 23))
+        return false;
+    dayAlarm &= 0x7F;
+    uint8_t alarmDate = BCDtoDEC(dayAlarm & 0x3F);
+
+    // Start from the next whole minute
+    uint16_t year = BCDtoDEC(_time[TIME_YEAR]) + 2000;
+    uint8_t month = BCDtoDEC(_time[TIME_MONTH]);
+    uint8_t date = BCDtoDEC(_time[TIME_DATE]);
+    int32_t days = daysFromCivil(year, month, date);
+    int16_t fromMinute = (BCDtoDEC(_time[TIME_HOURS]) * 60) + BCDtoDEC(_time[TIME_MINUTES]) + 1;
+
+    for (uint16_t i = 0; i < 400; i++, days++, fromMinute = 0) // Long enough for any date that exists
+    {
+        if (fromMinute >= 24 * 60)
+            continue; // It was the last minute of the day
+        if (i > 0)
+            civilFromDays(days, year, month, date);
+        if (dayEnabled)
+        {
+            if (dateMode && (date != alarmDate))
+                continue;
+            if (!dateMode && !(dayAlarm & (1 << ((days + 6) % 7)))) // 2000-01-01 was a Saturday
+                continue;
+        }
+        int16_t minuteOfDay = firstAlarmMinuteOfDay(fromMinute, hour, minute);
+        if (minuteOfDay < 0)
+            continue;
+        epoch = ((days + 10957L) * 86400L) + (minuteOfDay * 60L) - ((int32_t)quarterHours * 15 * 60); // 10957 days from 1970 to 2000
+        return true;
+    }
+    return false; // e.g. date 32, or a weekday mask of 0
+}
+
 /*********************************
 Given a bit location, enable the interrupt
 INTERRUPT_BLIE	4
@@ -967,21 +1962,30 @@ INTERRUPT_EIE	1
 *********************************/
 bool RV8803::enableHardwareInterrupt(uint8_t source)
 {
-    uint8_t value = readRegister(RV8803_CONTROL);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(RV8803_CONTROL, value) != RV8803_SUCCESS)
+        return false;
     value |= (1 << source); // Set the interrupt enable bit
     return writeRegister(RV8803_CONTROL, value);
 }
 
 bool RV8803::disableHardwareInterrupt(uint8_t source)
 {
-    uint8_t value = readRegister(RV8803_CONTROL);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(RV8803_CONTROL, value) != RV8803_SUCCESS)
+        return false;
     value &= ~(1 << source); // Clear the interrupt enable bit
     return writeRegister(RV8803_CONTROL, value);
 }
 
 bool RV8803::disableAllInterrupts()
 {
-    uint8_t value = readRegister(RV8803_CONTROL);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(RV8803_CONTROL, value) != RV8803_SUCCESS)
+        return false;
     value &= 1; // Clear all bits except for Reset
     return writeRegister(RV8803_CONTROL, value);
 }
@@ -1001,9 +2005,75 @@ bool RV8803::clearAllInterruptFlags() // Read the status register to clear the c
 
 bool RV8803::clearInterruptFlag(uint8_t flagToClear)
 {
-    uint8_t value = readRegister(RV8803_FLAG);
-    value &= ~(1 << flagToClear); // clear flag
-    return writeRegister(RV8803_FLAG, value);
+    return clearInterruptFlags(1 << flagToClear);
+}
+
+// Flags are cleared by writing 0 and left alone by writing 1, so a single write of the inverted mask
+// clears exactly these flags. No read-modify-write means a flag set in the meantime can't be lost.
+bool RV8803::clearInterruptFlags(uint8_t flagMask)
+{
+    return writeRegister(RV8803_FLAG, (uint8_t)~flagMask);
+}
+
+/*********************************
+Interrupt dispatcher
+Attach a handler to each flag you care about, then call serviceInterrupts() when the INT pin asserts
+(or from loop()). The flag register is read once, every set flag with a handler (or, for FLAG_UPDATE,
+with onSecond()/onMinute() subscribers) is cleared in a single write, and then the handlers are called
+with the bus lock released. Flags without a handler are left set.
+*********************************/
+bool RV8803::attachInterruptHandler(uint8_t flag, RV8803_InterruptHandler handler)
+{
+    if (flag > FLAG_UPDATE)
+        return false;
+    _interruptHandlers[flag] = handler;
+    return true;
+}
+
+bool RV8803::detachInterruptHandler(uint8_t flag)
+{
+    return attachInterruptHandler(flag, nullptr);
+}
+
+uint8_t RV8803::serviceInterrupts()
+{
+    uint8_t handled = 0;
+    RV8803_InterruptHandler handlers[FLAG_UPDATE + 1];
+    bool second = false, minute = false;
+    {
+        BusLock lock(*this); // Not held while the handlers run, so they can use the bus and so can other tasks
+        uint8_t flags;
+        if (tryReadRegister(RV8803_FLAG, flags) != RV8803_SUCCESS)
+            return 0;
+
+        noteSupplyFlags(flags); // Free, we have the flags anyway
+
+        memcpy(handlers, _interruptHandlers, sizeof(handlers)); // The ones the flags were cleared for
+        for (uint8_t flag = 0; flag <= FLAG_UPDATE; flag++)
+        {
+            if (handlers[flag] != nullptr)
+                handled |= (1 << flag);
+        }
+        if ((_onSecond != nullptr) || (_onMinute != nullptr))
+            handled |= (1 << FLAG_UPDATE);
+        handled &= flags;
+        if (handled == 0)
+            return 0;
+
+        // Clear before calling the handlers so an event during a handler sets its flag again
+        if (clearInterruptFlags(handled) == false)
+            return 0;
+        if (handled & (1 << FLAG_UPDATE))
+            countTimeUpdate(second, minute);
+    }
+
+    for (uint8_t flag = 0; flag <= FLAG_UPDATE; flag++)
+    {
+        if ((handled & (1 << flag)) && (handlers[flag] != nullptr))
+            handlers[flag]();
+    }
+    dispatchTimeUpdate(second, minute);
+    return handled;
 }
 
 uint8_t RV8803::BCDtoDEC(uint8_t val)
@@ -1029,7 +2099,10 @@ uint8_t RV8803::readTwoBits(uint8_t regAddr, uint8_t bitAddr)
 
 bool RV8803::writeBit(uint8_t regAddr, uint8_t bitAddr, bool bitToWrite)
 {
-    uint8_t value = readRegister(regAddr);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(regAddr, value) != RV8803_SUCCESS)
+        return false; // Don't write back a value we never read
     value &= ~(1 << bitAddr);
     value |= bitToWrite << bitAddr;
     return writeRegister(regAddr, value);
@@ -1037,7 +2110,10 @@ bool RV8803::writeBit(uint8_t regAddr, uint8_t bitAddr, bool bitToWrite)
 
 bool RV8803::writeBit(uint8_t regAddr, uint8_t bitAddr, uint8_t bitToWrite) // If we see an unsigned 8-bit, we know we have to write two bits.
 {
-    uint8_t value = readRegister(regAddr);
+    BusLock lock(*this);
+    uint8_t value;
+    if (tryReadRegister(regAddr, value) != RV8803_SUCCESS)
+        return false; // Don't write back a value we never read
     value &= ~(3 << bitAddr);
     value |= bitToWrite << bitAddr;
     return writeRegister(regAddr, value);
@@ -1045,29 +2121,148 @@ bool RV8803::writeBit(uint8_t regAddr, uint8_t bitAddr, uint8_t bitToWrite) // I
 
 uint8_t RV8803::readRegister(uint8_t addr)
 {
-    _i2cPort->beginTransmission(RV8803_ADDR);
-    _i2cPort->write(addr);
-    _i2cPort->endTransmission();
+    uint8_t value = 0;
+    tryReadRegister(addr, value); // On failure value stays 0. Check getLastError() to tell the difference
+    return value;
+}
+
+bool RV8803::writeRegister(uint8_t addr, uint8_t val)
+{
+    return tryWriteRegister(addr, val) == RV8803_SUCCESS;
+}
+
+bool RV8803::writeMultipleRegisters(uint8_t addr, uint8_t* values, uint8_t len)
+{
+    return tryWriteMultipleRegisters(addr, values, len) == RV8803_SUCCESS;
+}
+
+bool RV8803::readMultipleRegisters(uint8_t addr, uint8_t* dest, uint8_t len)
+{
+    return tryReadMultipleRegisters(addr, dest, len) == RV8803_SUCCESS;
+}
+
+RV8803_Result RV8803::tryReadRegister(uint8_t addr, uint8_t &value)
+{
+    return tryReadMultipleRegisters(addr, &value, 1);
+}
 
-    // typecasting the 1 parameter in requestFrom so that the compiler
-    // doesn't give us a warning about multiple candidates
-    if (_i2cPort->requestFrom(static_cast<uint8_t>(RV8803_ADDR), static_cast<uint8_t>(1)) != 0) {
-        return _i2cPort->read();
+RV8803_Result RV8803::tryWriteRegister(uint8_t addr, uint8_t val)
+{
+    return tryWriteMultipleRegisters(addr, &val, 1);
+}
+
+RV8803_Result RV8803::tryReadMultipleRegisters(uint8_t addr, uint8_t* dest, uint8_t len)
+{
+    uint32_t startMicros = micros();
+    uint16_t backoffMicros = _initialBackoffMicros;
+    uint8_t attempt = 0;
+    while (true)
+    {
+        {
+            BusLock lock(*this); // Taken per attempt, so the backoff only holds it if our caller does
+            _lastError = readRegistersOnce(addr, dest, len);
+        }
+        if ((_lastError == RV8803_SUCCESS) || (waitBeforeRetry(attempt++, startMicros, backoffMicros) == false))
+            return _lastError;
     }
-    return false;
 }
 
-bool RV8803::writeRegister(uint8_t addr, uint8_t val)
+RV8803_Result RV8803::tryWriteMultipleRegisters(uint8_t addr, const uint8_t* values, uint8_t len)
+{
+    uint32_t startMicros = micros();
+    uint16_t backoffMicros = _initialBackoffMicros;
+    uint8_t attempt = 0;
+    while (true)
+    {
+        {
+            BusLock lock(*this);
+            _lastError = writeRegistersOnce(addr, values, len);
+        }
+        if ((_lastError == RV8803_SUCCESS) || (waitBeforeRetry(attempt++, startMicros, backoffMicros) == false))
+            return _lastError;
+    }
+}
+
+// Clock SCL until the slave releases SDA (at most nine clocks - one byte plus ACK), then
+// generate a STOP and hand the pins back to the Wire library
+bool RV8803::recoverBus()
+{
+    BusLock lock(*this);
+    if (_recoverBus != nullptr)
+        _recoverBus(*_i2cPort);
+
+    if ((_sclPin == RV8803_NO_PIN) || (_sdaPin == RV8803_NO_PIN))
+        return (_recoverBus != nullptr);
+
+    pinMode(_sdaPin, INPUT_PULLUP);
+    pinMode(_sclPin, OUTPUT);
+    for (uint8_t i = 0; (i < 9) && (digitalRead(_sdaPin) == LOW); i++)
+    {
+        digitalWrite(_sclPin, LOW);
+        delayMicroseconds(5);
+        digitalWrite(_sclPin, HIGH);
+        delayMicroseconds(5);
+    }
+
+    // STOP: SDA rising while SCL is high
+    pinMode(_sdaPin, OUTPUT);
+    digitalWrite(_sdaPin, LOW);
+    delayMicroseconds(5);
+    digitalWrite(_sclPin, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(_sdaPin, HIGH);
+    delayMicroseconds(5);
+
+    bool released = (digitalRead(_sdaPin) == HIGH);
+    _i2cPort->begin(); // Give the pins back to the I2C peripheral. Note: this may reset the clock speed on some cores
+    return released;
+}
+
+// Returns true if another attempt should be made after waiting (and recovering the bus if configured)
+bool RV8803::waitBeforeRetry(uint8_t attempt, uint32_t startMicros, uint16_t &backoffMicros)
+{
+    if (attempt >= _maxRetries)
+        return false;
+    if ((micros() - startMicros) + backoffMicros > _deadlineMicros)
+        return false; // Waiting would take us past the deadline
+
+    recoverBus();
+    delayMicroseconds(backoffMicros);
+    if (backoffMicros < 0x8000)
+        backoffMicros <<= 1;
+    return true;
+}
+
+RV8803_Result RV8803::readRegistersOnce(uint8_t addr, uint8_t* dest, uint8_t len)
 {
     _i2cPort->beginTransmission(RV8803_ADDR);
     _i2cPort->write(addr);
-    _i2cPort->write(val);
-    if (_i2cPort->endTransmission() != 0)
-        return (false); // Error: Sensor did not ack
-    return (true);
+    RV8803_Result result = endTransmissionResult(_i2cPort->endTransmission());
+    if (result == RV8803_SUCCESS) // Otherwise the sensor did not ack
+    {
+        // typecasting the parameters in requestFrom so that the compiler
+        // doesn't give us a warning about multiple candidates
+        uint8_t received = _i2cPort->requestFrom(static_cast<uint8_t>(RV8803_ADDR), static_cast<uint8_t>(len));
+        if (received != len)
+        {
+            while (_i2cPort->available())
+                _i2cPort->read(); // Don't leave a partial read behind for the next transaction
+            result = RV8803_ERROR_SHORT_READ;
+        }
+        else
+        {
+            for (uint8_t i = 0; i < len; i++) {
+                dest[i] = _i2cPort->read();
+            }
+        }
+    }
+
+    if (_traceBuffer != nullptr)
+        traceTransaction(false, addr, dest, len, result);
+    return result;
 }
 
-bool RV8803::writeMultipleRegisters(uint8_t addr, uint8_t* values, uint8_t len)
+RV8803_Result RV8803::writeRegistersOnce(uint8_t addr, const uint8_t* values, uint8_t len)
 {
     _i2cPort->beginTransmission(RV8803_ADDR);
     _i2cPort->write(addr);
@@ -1075,27 +2270,104 @@ bool RV8803::writeMultipleRegisters(uint8_t addr, uint8_t* values, uint8_t len)
         _i2cPort->write(values[i]);
     }
 
-    if (_i2cPort->endTransmission() != 0)
-        return (false); // Error: Sensor did not ack
-    return (true);
+    RV8803_Result result = endTransmissionResult(_i2cPort->endTransmission());
+    if (_traceBuffer != nullptr)
+        traceTransaction(true, addr, values, len, result);
+    return result;
+}
+
+/*********************************
+Bus trace recorder
+*********************************/
+#define TRACE_HEADER_LENGTH	7
+#define TRACE_WRITE			0x80
+#define TRACE_VERSION		1
+
+void RV8803::setTraceBuffer(uint8_t* buffer, uint16_t size)
+{
+    _traceBuffer = (size >= TRACE_HEADER_LENGTH) ? buffer : nullptr;
+    _traceSize = size;
+    clearTrace();
+}
+
+void RV8803::clearTrace()
+{
+    _traceHead = 0;
+    _traceTail = 0;
+    _traceUsed = 0;
+    _traceRecords = 0;
+    _traceDropped = 0;
+}
+
+uint16_t RV8803::getTraceRecordCount()
+{
+    return _traceRecords;
+}
+
+uint32_t RV8803::getTraceDroppedCount()
+{
+    return _traceDropped;
 }
 
-bool RV8803::readMultipleRegisters(uint8_t addr, uint8_t* dest, uint8_t len)
+void RV8803::traceByte(uint8_t value)
 {
-    _i2cPort->beginTransmission(RV8803_ADDR);
-    _i2cPort->write(addr);
-    if (_i2cPort->endTransmission() != 0)
-        return (false); // Error: Sensor did not ack
+    _traceBuffer[_traceHead] = value;
+    if (++_traceHead == _traceSize)
+        _traceHead = 0;
+}
 
-    _i2cPort->requestFrom(static_cast<uint8_t>(RV8803_ADDR), len);
-    for (uint8_t i = 0; i < len; i++) {
-        dest[i] = _i2cPort->read();
+void RV8803::traceTransaction(bool write, uint8_t addr, const uint8_t* data, uint8_t len, RV8803_Result result)
+{
+    uint8_t dataLength = (write || (result == RV8803_SUCCESS)) ? len : 0;
+    uint16_t recordLength = TRACE_HEADER_LENGTH + dataLength;
+    if (recordLength > _traceSize)
+    {
+        _traceDropped++;
+        return;
     }
 
-    return (true);
+    while ((_traceSize - _traceUsed) < recordLength) // Drop the oldest records until this one fits
+    {
+        uint16_t lengthIndex = (_traceTail + 2) % _traceSize;
+        uint8_t oldFlags = _traceBuffer[_traceTail];
+        uint16_t oldLength = TRACE_HEADER_LENGTH;
+        if ((oldFlags & TRACE_WRITE) || ((oldFlags & 0x07) == RV8803_SUCCESS))
+            oldLength += _traceBuffer[lengthIndex];
+        _traceTail = (_traceTail + oldLength) % _traceSize;
+        _traceUsed -= oldLength;
+        _traceRecords--;
+        _traceDropped++;
+    }
+
+    uint32_t timestamp = micros();
+    traceByte((write ? TRACE_WRITE : 0) | (result & 0x07));
+    traceByte(addr);
+    traceByte(len);
+    for (uint8_t i = 0; i < 4; i++)
+        traceByte(timestamp >> (8 * i));
+    for (uint8_t i = 0; i < dataLength; i++)
+        traceByte(data[i]);
+    _traceUsed += recordLength;
+    _traceRecords++;
+}
+
+size_t RV8803::exportTrace(Print &output)
+{
+    size_t written = output.write((const uint8_t*)"RV88", 4);
+    written += output.write((uint8_t)TRACE_VERSION);
+    if (_traceBuffer == nullptr)
+        return written;
+    uint16_t index = _traceTail;
+    for (uint16_t i = 0; i < _traceUsed; i++)
+    {
+        written += output.write(_traceBuffer[index]);
+        if (++index == _traceSize)
+            index = 0;
+    }
+    return written;
 }
 
-void RV8803::setTimeZoneQuarterHours(int8_t quarterHours)
+bool RV8803::setTimeZoneQuarterHours(int8_t quarterHours)
 {
     // Write the time zone to RV8803_RAM as int8_t (signed) in 15 minute increments
     union
@@ -1104,7 +2376,7 @@ void RV8803::setTimeZoneQuarterHours(int8_t quarterHours)
         uint8_t unsigned8;
     } signedUnsigned8;
     signedUnsigned8.signed8 = quarterHours;
-    writeRegister(RV8803_RAM, signedUnsigned8.unsigned8); // Store as uint8_t - without ambiguity
+    return writeRegister(RV8803_RAM, signedUnsigned8.unsigned8); // Store as uint8_t - without ambiguity
 }
 int8_t RV8803::getTimeZoneQuarterHours(void)
 {
@@ -1247,3 +2519,621 @@ time_t RV8803::_timegm(struct tm *tm, bool use1970sEpoch)
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+//****************************************************************************//
+//
+//  Configuration blob
+//
+//****************************************************************************//
+
+// RAM up to CONTROL, using the lower mirror of the alarm to control registers so it is one burst
+#define CONFIG_LOW_BLOCK_START		RV8803_RAM
+#define CONFIG_LOW_BLOCK_LENGTH		(CONFIG_CONTROL + 1)
+// OFFSET to EVENT_CONTROL. The two registers between them are reserved: read in the burst but not kept
+#define CONFIG_HIGH_BLOCK_LENGTH	(RV8803_EVENT_CONTROL - RV8803_OFFSET + 1)
+
+// CRC-8, polynomial 0x07
+static uint8_t crc8(const uint8_t* data, uint8_t len, uint8_t crc)
+{
+    while (len--)
+    {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+    return crc;
+}
+
+static uint8_t configCRC(const RV8803_Config &config)
+{
+    return crc8(config.registers, RV8803_CONFIG_LENGTH, crc8(&config.version, 1, 0));
+}
+
+bool RV8803_Config::isValid() const
+{
+    return (version == RV8803_CONFIG_VERSION) && (crc == configCRC(*this));
+}
+
+void RV8803_Config::updateCRC()
+{
+    crc = configCRC(*this);
+}
+
+bool RV8803::readConfig(RV8803_Config &config)
+{
+    BusLock lock(*this);
+    uint8_t high[CONFIG_HIGH_BLOCK_LENGTH];
+    if (tryReadMultipleRegisters(CONFIG_LOW_BLOCK_START, config.registers, CONFIG_LOW_BLOCK_LENGTH) != RV8803_SUCCESS)
+        return false;
+    if (tryReadMultipleRegisters(RV8803_OFFSET, high, CONFIG_HIGH_BLOCK_LENGTH) != RV8803_SUCCESS)
+        return false;
+    config.registers[CONFIG_OFFSET] = high[0];
+    config.registers[CONFIG_EVENT_CONTROL] = high[RV8803_EVENT_CONTROL - RV8803_OFFSET];
+    config.version = RV8803_CONFIG_VERSION;
+    config.updateCRC();
+    return true;
+}
+
+bool RV8803::diffConfig(const RV8803_Config &config, uint16_t &differences)
+{
+    RV8803_Config current;
+    if (readConfig(current) == false)
+        return false;
+    differences = configDifferences(current, config);
+    return true;
+}
+
+uint16_t RV8803::configDifferences(const RV8803_Config &current, const RV8803_Config &config)
+{
+    uint16_t differences = 0;
+    for (uint8_t i = 0; i < RV8803_CONFIG_LENGTH; i++)
+    {
+        if ((i != CONFIG_FLAG) && (current.registers[i] != config.registers[i]))
+            differences |= 1 << i;
+    }
+    return differences;
+}
+
+bool RV8803::writeConfig(const RV8803_Config &config)
+{
+    if (config.isValid() == false)
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return false;
+    }
+
+    BusLock lock(*this);
+    RV8803_Config current;
+    if (readConfig(current) == false)
+        return false;
+    return writeConfigChanges(current, config);
+}
+
+// current is what the RTC holds now. It is modified
+bool RV8803::writeConfigChanges(RV8803_Config &current, const RV8803_Config &config)
+{
+    uint8_t target[RV8803_CONFIG_LENGTH];
+    memcpy(target, config.registers, RV8803_CONFIG_LENGTH);
+    target[CONFIG_EXTENSION] &= ~(1 << EXTENSION_TEST); // Factory test mode
+    target[CONFIG_CONTROL] &= ~(1 << CONTROL_RESET); // Would stop the clock
+
+    // The timer must be stopped while its value changes. Clear TE first; the extension run below sets it again
+    bool timerChanges = (target[CONFIG_TIMER_0] != current.registers[CONFIG_TIMER_0]) || (target[CONFIG_TIMER_1] != current.registers[CONFIG_TIMER_1]);
+    if (timerChanges && (current.registers[CONFIG_EXTENSION] & (1 << EXTENSION_TE)))
+    {
+        current.registers[CONFIG_EXTENSION] &= ~(1 << EXTENSION_TE);
+        if (tryWriteRegister(RV8803_EXTENSION, current.registers[CONFIG_EXTENSION]) != RV8803_SUCCESS)
+            return false;
+    }
+
+    // Write each run of differing registers in the low block in one burst
+    uint8_t first = 0;
+    while (first < CONFIG_LOW_BLOCK_LENGTH)
+    {
+        if ((first == CONFIG_FLAG) || (target[first] == current.registers[first]))
+        {
+            first++;
+            continue;
+        }
+        uint8_t last = first;
+        while ((last + 1 < CONFIG_LOW_BLOCK_LENGTH) && (last + 1 != CONFIG_FLAG) && (target[last + 1] != current.registers[last + 1]))
+            last++;
+        if (tryWriteMultipleRegisters(CONFIG_LOW_BLOCK_START + first, &target[first], last - first + 1) != RV8803_SUCCESS)
+            return false;
+        first = last + 1;
+    }
+
+    if ((target[CONFIG_OFFSET] != current.registers[CONFIG_OFFSET])
+        && (tryWriteRegister(RV8803_OFFSET, target[CONFIG_OFFSET]) != RV8803_SUCCESS))
+        return false;
+    if ((target[CONFIG_EVENT_CONTROL] != current.registers[CONFIG_EVENT_CONTROL])
+        && (tryWriteRegister(RV8803_EVENT_CONTROL, target[CONFIG_EVENT_CONTROL]) != RV8803_SUCCESS))
+        return false;
+
+    _updateFrequency = 0xFF; // USEL may have changed
+    if ((target[CONFIG_EXTENSION] & (1 << EXTENSION_TE)) && ((current.registers[CONFIG_EXTENSION] & (1 << EXTENSION_TE)) == 0))
+        _timerStartKnown = false; // Started here, without noting the time
+    return true;
+}
+
+// A begin() for firmware which wakes from deep sleep many times a day. One readConfig() (two bursts, which
+// include FLAG and CONTROL) tells us everything:
+//  - V2F set: the RTC has been through a power-on reset, so write the whole profile
+//  - otherwise, write only the registers which differ from the profile, if any
+// profile is normally a golden RV8803_Config kept in flash by the caller, from an earlier readConfig().
+// The RTC has only one byte of RAM (used for the time zone), so the full register contents are compared
+// instead of a fingerprint stored on the chip.
+RV8803_BootPath RV8803::begin(const RV8803_Config &profile, TwoWire &wirePort)
+{
+    if (profile.isValid() == false)
+    {
+        _lastError = RV8803_ERROR_INVALID_ARGUMENT;
+        return RV8803_BOOT_FAILED;
+    }
+
+    BusLock lock(*this);
+    if (begin(wirePort) == false)
+        return RV8803_BOOT_FAILED;
+
+    RV8803_Config current;
+    if (readConfig(current) == false)
+        return RV8803_BOOT_FAILED;
+    uint8_t flags = current.registers[CONFIG_FLAG];
+    noteSupplyFlags(flags); // Time validity comes for free
+
+    if (flags & (1 << FLAG_V2F))
+        return writeConfigChanges(current, profile) ? RV8803_BOOT_COLD : RV8803_BOOT_FAILED;
+
+    RV8803_Config target = profile;
+    target.registers[CONFIG_CONTROL] &= ~(1 << CONTROL_RESET); // As writeConfig() would leave them
+    target.registers[CONFIG_EXTENSION] &= ~(1 << EXTENSION_TEST);
+    if (configDifferences(current, target) == 0)
+        return RV8803_BOOT_WARM;
+    return writeConfigChanges(current, profile) ? RV8803_BOOT_RECONFIGURED : RV8803_BOOT_FAILED;
+}
+
+//****************************************************************************//
+//
+//  Snapshot arithmetic
+//
+//****************************************************************************//
+
+#define HUNDREDTHS_PER_DAY	8640000L
+
+RV8803_Snapshot RV8803::getSnapshot()
+{
+    return RV8803_Snapshot::fromTime(_time);
+}
+
+RV8803_Snapshot RV8803_Snapshot::fromTime(const uint8_t* time)
+{
+    RV8803_Snapshot snapshot;
+    snapshot.hundredths = RV8803::BCDtoDEC(time[TIME_HUNDREDTHS]);
+    snapshot.seconds = RV8803::BCDtoDEC(time[TIME_SECONDS]);
+    snapshot.minutes = RV8803::BCDtoDEC(time[TIME_MINUTES]);
+    snapshot.hours = RV8803::BCDtoDEC(time[TIME_HOURS]);
+    snapshot.weekday = 0;
+    for (uint8_t bits = time[TIME_WEEKDAY] & 0x7F; bits > 1; bits >>= 1)
+        snapshot.weekday++;
+    snapshot.date = RV8803::BCDtoDEC(time[TIME_DATE]);
+    snapshot.month = RV8803::BCDtoDEC(time[TIME_MONTH]);
+    snapshot.year = RV8803::BCDtoDEC(time[TIME_YEAR]) + 2000;
+    return snapshot;
+}
+
+void RV8803_Snapshot::toTime(uint8_t* time) const
+{
+    time[TIME_HUNDREDTHS] = RV8803::DECtoBCD(hundredths);
+    time[TIME_SECONDS] = RV8803::DECtoBCD(seconds);
+    time[TIME_MINUTES] = RV8803::DECtoBCD(minutes);
+    time[TIME_HOURS] = RV8803::DECtoBCD(hours);
+    time[TIME_WEEKDAY] = 1 << weekday;
+    time[TIME_DATE] = RV8803::DECtoBCD(date);
+    time[TIME_MONTH] = RV8803::DECtoBCD(month);
+    time[TIME_YEAR] = RV8803::DECtoBCD(year - 2000);
+}
+
+bool RV8803_Snapshot::isSet() const
+{
+    return (month != 0);
+}
+
+// Hundredths since midnight
+static int32_t hundredthsOfDay(const RV8803_Snapshot &snapshot)
+{
+    return (((((snapshot.hours * 60L) + snapshot.minutes) * 60L) + snapshot.seconds) * 100L) + snapshot.hundredths;
+}
+
+int32_t RV8803_Snapshot::hundredthsSince(const RV8803_Snapshot &earlier) const
+{
+    int32_t days = daysFromCivil(year, month, date) - daysFromCivil(earlier.year, earlier.month, earlier.date);
+    int32_t partDay = hundredthsOfDay(*this) - hundredthsOfDay(earlier); // Within +/- one day
+    if ((days > 0) && (partDay < 0)) // Give the part day the same sign as days, so that days alone decides saturation
+    {
+        days--;
+        partDay += HUNDREDTHS_PER_DAY;
+    }
+    else if ((days < 0) && (partDay > 0))
+    {
+        days++;
+        partDay -= HUNDREDTHS_PER_DAY;
+    }
+
+    // INT32_MAX is 248.55 days of hundredths. Keep days * HUNDREDTHS_PER_DAY in range before adding the part day
+    if (days > 248)
+        return INT32_MAX;
+    if (days < -248)
+        return INT32_MIN;
+    int32_t whole = days * HUNDREDTHS_PER_DAY;
+    if ((partDay > 0) && (whole > INT32_MAX - partDay))
+        return INT32_MAX;
+    if ((partDay < 0) && (whole < INT32_MIN - partDay))
+        return INT32_MIN;
+    return whole + partDay;
+}
+
+int8_t RV8803_Snapshot::compare(const RV8803_Snapshot &other) const
+{
+    // Most to least significant, so no arithmetic is needed
+    const uint8_t mine[] = { month, date, hours, minutes, seconds, hundredths };
+    const uint8_t theirs[] = { other.month, other.date, other.hours, other.minutes, other.seconds, other.hundredths };
+    if (year != other.year)
+        return (year < other.year) ? -1 : 1;
+    for (uint8_t i = 0; i < sizeof(mine); i++)
+    {
+        if (mine[i] != theirs[i])
+            return (mine[i] < theirs[i]) ? -1 : 1;
+    }
+    return 0;
+}
+
+bool RV8803_Snapshot::addHundredths(int32_t delta)
+{
+    int32_t days = daysFromCivil(year, month, date) + (delta / HUNDREDTHS_PER_DAY);
+    int32_t partDay = hundredthsOfDay(*this) + (delta % HUNDREDTHS_PER_DAY);
+    if (partDay < 0)
+    {
+        partDay += HUNDREDTHS_PER_DAY;
+        days--;
+    }
+    else if (partDay >= HUNDREDTHS_PER_DAY)
+    {
+        partDay -= HUNDREDTHS_PER_DAY;
+        days++;
+    }
+    if ((days < 0) || (days >= 36525)) // 2000-01-01 to 2099-12-31
+        return false;
+
+    civilFromDays(days, year, month, date);
+    weekday = (days + 6) % 7; // 2000-01-01 was a Saturday
+    hundredths = partDay % 100;
+    partDay /= 100;
+    seconds = partDay % 60;
+    partDay /= 60;
+    minutes = partDay % 60;
+    hours = partDay / 60;
+    return true;
+}
+
+//****************************************************************************//
+//
+//  Monotonic clock
+//
+//****************************************************************************//
+
+// The monotonic clock is the RTC time plus _monotonicOffset. Every snapshot re-bases it on the RTC, so it keeps
+// the accuracy of the crystal; every time set through the library moves the offset so that the clock carries on
+// from where it was. setTimeFields() only writes some of the fields, so the time it set isn't known until the next
+// snapshot; until then the old base carries on, and that snapshot moves the offset. Changes made behind our back (another master, setHundredthsToZero) can only hold it still
+// for a while, never take it backwards.
+void RV8803::noteClock(const uint8_t* time, bool stepped)
+{
+    if (stepped && _clockKnown)
+        getMonotonicMillis(); // Where we are, by the old time
+
+    _clockMillis = millisFromTime(time);
+    _clockMillisAt = millis();
+
+    if (stepped && _clockKnown)
+        _monotonicOffset = (int64_t)_monotonicLast - _clockMillis; // Carry on from there, by the new time
+    _clockKnown = true;
+    _clockStepPending = false;
+}
+
+uint64_t RV8803::getMonotonicMillis()
+{
+    if (_clockKnown == false)
+        return _monotonicLast; // Nothing read or written yet
+
+    int64_t now = _clockMillis + (uint32_t)(millis() - _clockMillisAt) + _monotonicOffset;
+    if ((now > 0) && ((uint64_t)now > _monotonicLast))
+        _monotonicLast = now;
+    return _monotonicLast;
+}
+
+uint64_t RV8803::getMonotonicHundredths()
+{
+    return getMonotonicMillis() / 10;
+}
+
+#ifdef RV8803_HAS_CHRONO
+//****************************************************************************//
+//
+//  std::chrono clock
+//
+//****************************************************************************//
+
+RV8803 *RV8803_Clock::_rtc = nullptr;
+uint32_t RV8803_Clock::_stalenessMillis = 1000;
+bool RV8803_Clock::_haveSnapshot = false;
+int64_t RV8803_Clock::_snapshotHundredths = 0;
+uint32_t RV8803_Clock::_snapshotMillis = 0;
+
+#define DAYS_FROM_1970_TO_2000	10957L
+
+void RV8803_Clock::attach(RV8803 &rtc, uint32_t stalenessMillis)
+{
+    _rtc = &rtc;
+    _stalenessMillis = stalenessMillis;
+    _haveSnapshot = false;
+}
+
+void RV8803_Clock::invalidate()
+{
+    _haveSnapshot = false;
+}
+
+RV8803_Clock::time_point RV8803_Clock::now()
+{
+    uint32_t nowMillis = millis();
+    if ((_rtc != nullptr) && ((_haveSnapshot == false) || ((nowMillis - _snapshotMillis) > _stalenessMillis)))
+    {
+        uint8_t time[TIME_ARRAY_LENGTH];
+        int8_t quarterHours;
+        if (_rtc->readTime(time, quarterHours)) // Not updateTime(): the RV8803's own snapshot belongs to its owner
+        {
+            RV8803_Snapshot snapshot = RV8803_Snapshot::fromTime(time);
+            int32_t days = daysFromCivil(snapshot.year, snapshot.month, snapshot.date) + DAYS_FROM_1970_TO_2000;
+            _snapshotHundredths = ((int64_t)days * HUNDREDTHS_PER_DAY) + hundredthsOfDay(snapshot) - ((int32_t)quarterHours * 15 * 60 * 100);
+            _snapshotMillis = nowMillis;
+            _haveSnapshot = true;
+        }
+        // If the read failed we carry on extrapolating the old snapshot, if there is one
+    }
+    if (_haveSnapshot == false)
+        return time_point();
+    return time_point(duration(_snapshotHundredths + ((uint32_t)(millis() - _snapshotMillis) / 10)));
+}
+
+std::chrono::system_clock::time_point RV8803_Clock::to_sys(const time_point &t)
+{
+    // Both clocks count from 1970-01-01 UTC
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(t.time_since_epoch()));
+}
+
+RV8803_Clock::time_point RV8803_Clock::from_sys(const std::chrono::system_clock::time_point &t)
+{
+    return time_point(std::chrono::duration_cast<duration>(t.time_since_epoch()));
+}
+#endif
+
+//****************************************************************************//
+//
+//  NMEA time parser
+//
+//****************************************************************************//
+
+#define NMEA_HAVE_TIME	0x01
+#define NMEA_HAVE_DATE	0x02
+#define NMEA_HAVE_FIX	0x04
+
+static uint8_t hexDigit(char c)
+{
+    if ((c >= '0') && (c <= '9'))
+        return c - '0';
+    if ((c >= 'A') && (c <= 'F'))
+        return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f'))
+        return c - 'a' + 10;
+    return 0xFF;
+}
+
+// Two decimal digits starting at str, or 0xFF if they aren't digits
+static uint8_t twoDigits(const char* str)
+{
+    if ((str[0] < '0') || (str[0] > '9') || (str[1] < '0') || (str[1] > '9'))
+        return 0xFF;
+    return ((str[0] - '0') * 10) + (str[1] - '0');
+}
+
+bool RV8803_NMEA::process(char c)
+{
+    if (c == '$') // Start of a sentence, wherever we were
+    {
+        _state = IN_SENTENCE;
+        _type = OTHER_SENTENCE;
+        _fieldIndex = 0;
+        _fieldLength = 0;
+        _checksum = 0;
+        _pendingFields = 0;
+        memset(_pending, 0, TIME_ARRAY_LENGTH); // A ZDA with a missing day or month mustn't get the last sentence's
+        return false;
+    }
+
+    switch (_state)
+    {
+    case IN_SENTENCE:
+        if (c == '*')
+        {
+            endField();
+            _state = IN_CHECKSUM;
+            _receivedChecksum = 0;
+            _checksumDigits = 0;
+        }
+        else if ((c == '\r') || (c == '\n'))
+            _state = WAIT_FOR_START; // No checksum, so don't trust it
+        else
+        {
+            _checksum ^= c;
+            if (c == ',')
+                endField();
+            else if (_fieldLength < RV8803_NMEA_FIELD_LENGTH)
+                _field[_fieldLength++] = c;
+        }
+        return false;
+
+    case IN_CHECKSUM:
+    {
+        uint8_t digit = hexDigit(c);
+        if (digit == 0xFF)
+        {
+            _state = WAIT_FOR_START;
+            return false;
+        }
+        _receivedChecksum = (_receivedChecksum << 4) | digit;
+        if (++_checksumDigits < 2)
+            return false;
+        _state = WAIT_FOR_START;
+        if (_receivedChecksum != _checksum)
+        {
+            _checksumErrors++;
+            return false;
+        }
+        return endSentence();
+    }
+
+    default:
+        return false;
+    }
+}
+
+bool RV8803_NMEA::update(Stream &stream)
+{
+    bool newTime = false;
+    while (stream.available())
+    {
+        if (process(stream.read()))
+            newTime = true;
+    }
+    return newTime;
+}
+
+// Work out what the field just finished tells us. Field 0 is the talker and sentence type, e.g. GPRMC or GNZDA
+void RV8803_NMEA::endField()
+{
+    _field[_fieldLength] = '\0';
+    uint8_t index = _fieldIndex++;
+    uint8_t length = _fieldLength;
+    _fieldLength = 0;
+
+    if (index == 0)
+    {
+        if ((length == 5) && (strcmp(&_field[2], "RMC") == 0))
+            _type = RMC_SENTENCE;
+        else if ((length == 5) && (strcmp(&_field[2], "ZDA") == 0))
+        {
+            _type = ZDA_SENTENCE;
+            _pendingFields |= NMEA_HAVE_FIX; // ZDA has no status field. Its fields are empty without a fix
+        }
+        return;
+    }
+    if (_type == OTHER_SENTENCE)
+        return;
+
+    if (index == 1) // hhmmss.ss in both sentences
+    {
+        if (length < 6)
+            return;
+        uint8_t hours = twoDigits(&_field[0]);
+        uint8_t minutes = twoDigits(&_field[2]);
+        uint8_t seconds = twoDigits(&_field[4]);
+        if ((hours > 23) || (minutes > 59) || (seconds > 59))
+            return;
+        uint8_t hundredths = 0;
+        if ((length >= 8) && (_field[6] == '.'))
+        {
+            if (length == 8)
+                _field[8] = '0'; // hhmmss.s is in tenths
+            hundredths = twoDigits(&_field[7]);
+            if (hundredths > 99)
+                hundredths = 0;
+        }
+        _pending[TIME_HUNDREDTHS] = RV8803::DECtoBCD(hundredths);
+        _pending[TIME_SECONDS] = RV8803::DECtoBCD(seconds);
+        _pending[TIME_MINUTES] = RV8803::DECtoBCD(minutes);
+        _pending[TIME_HOURS] = RV8803::DECtoBCD(hours);
+        _pendingFields |= NMEA_HAVE_TIME;
+        return;
+    }
+
+    if (_type == RMC_SENTENCE)
+    {
+        if ((index == 2) && (length == 1) && (_field[0] == 'A'))
+            _pendingFields |= NMEA_HAVE_FIX;
+        else if ((index == 9) && (length == 6)) // ddmmyy
+        {
+            uint8_t date = twoDigits(&_field[0]);
+            uint8_t month = twoDigits(&_field[2]);
+            uint8_t year = twoDigits(&_field[4]);
+            if ((date > 31) || (month > 12) || (year > 99))
+                return;
+            _pending[TIME_DATE] = RV8803::DECtoBCD(date);
+            _pending[TIME_MONTH] = RV8803::DECtoBCD(month);
+            _pending[TIME_YEAR] = RV8803::DECtoBCD(year);
+            _pendingFields |= NMEA_HAVE_DATE;
+        }
+    }
+    else // ZDA: day, month and four digit year in fields 2, 3 and 4
+    {
+        if ((index == 2) && (length == 2))
+            _pending[TIME_DATE] = RV8803::DECtoBCD(twoDigits(_field) > 31 ? 0 : twoDigits(_field));
+        else if ((index == 3) && (length == 2))
+            _pending[TIME_MONTH] = RV8803::DECtoBCD(twoDigits(_field) > 12 ? 0 : twoDigits(_field));
+        else if ((index == 4) && (length == 4) && (_field[0] == '2') && (_field[1] == '0') && (twoDigits(&_field[2]) <= 99))
+        {
+            _pending[TIME_YEAR] = RV8803::DECtoBCD(twoDigits(&_field[2]));
+            _pendingFields |= NMEA_HAVE_DATE;
+        }
+    }
+}
+
+// Called once the checksum has matched. Returns true if the sentence gave us a new time
+bool RV8803_NMEA::endSentence()
+{
+    if ((_type == OTHER_SENTENCE) || (_pendingFields != (NMEA_HAVE_TIME | NMEA_HAVE_DATE | NMEA_HAVE_FIX)))
+        return false;
+    if ((_pending[TIME_DATE] == 0) || (_pending[TIME_MONTH] == 0))
+        return false;
+
+    _pending[TIME_WEEKDAY] = 1 << RV8803::dayOfWeek(RV8803::BCDtoDEC(_pending[TIME_YEAR]) + 2000, RV8803::BCDtoDEC(_pending[TIME_MONTH]),
+                                                    RV8803::BCDtoDEC(_pending[TIME_DATE]));
+    if (RV8803::isValidTime(_pending) == false)
+        return false;
+
+    memcpy(_time, _pending, TIME_ARRAY_LENGTH);
+    _timeMillis = millis();
+    _sentences++;
+    return true;
+}
+
+bool RV8803_NMEA::getTime(uint8_t* time) const
+{
+    if (_time[TIME_MONTH] == 0)
+        return false;
+    memcpy(time, _time, TIME_ARRAY_LENGTH);
+    return true;
+}
+
+uint32_t RV8803_NMEA::getTimeMillis() const
+{
+    return _timeMillis;
+}
+
+uint32_t RV8803_NMEA::getSentenceCount() const
+{
+    return _sentences;
+}
+
+uint32_t RV8803_NMEA::getChecksumErrorCount() const
+{
+    return _checksumErrors;
+}
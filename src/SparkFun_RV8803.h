@@ -29,6 +29,14 @@ Distributed as-is; no warranty is given.
 #include <Wire.h>
 #include <time.h>
 
+//The std::chrono clock adapter needs C++17 and a standard library with <chrono> (not AVR)
+#if (__cplusplus >= 201703L) && defined(__has_include)
+#if __has_include(<chrono>)
+#define RV8803_HAS_CHRONO
+#include <chrono>
+#endif
+#endif
+
 //The 7-bit I2C address of the RV8803
 #define RV8803_ADDR							0x32
 
@@ -127,6 +135,58 @@ Distributed as-is; no warranty is given.
 
 #define TIME_ARRAY_LENGTH 8 // Total number of writable values in device
 
+//Language of the day and month names. Choose one at compile time, e.g. build_flags = -DRV8803_LOCALE=RV8803_LOCALE_DE
+#define RV8803_LOCALE_EN					0
+#define RV8803_LOCALE_DE					1
+#define RV8803_LOCALE_FR					2
+#define RV8803_LOCALE_ES					3
+#ifndef RV8803_LOCALE
+#define RV8803_LOCALE						RV8803_LOCALE_EN
+#endif
+
+//Buffer sizes (including the \0 terminator) of the string functions
+#define RV8803_DATE_STRING_LENGTH			11 // dd/mm/yyyy or mm/dd/yyyy
+#define RV8803_TIME_STRING_LENGTH			11 // hh:mm:ss or hh:mm:ssXM
+#define RV8803_TIMESTAMP_STRING_LENGTH		14 // hh:mm:ss:HHXM
+#define RV8803_TIME8601_STRING_LENGTH		21 // yyyy-mm-ddThh:mm:ss
+#define RV8803_TIME8601TZ_STRING_LENGTH		27 // yyyy-mm-ddThh:mm:ss+hh:mm
+#define RV8803_DAY_STRING_LENGTH			11
+#define RV8803_DAY_SHORT_STRING_LENGTH		5
+#define RV8803_ORDINAL_STRING_LENGTH		6
+#define RV8803_MONTH_STRING_LENGTH			11
+#define RV8803_MONTH_SHORT_STRING_LENGTH	5
+
+//Default bus retry policy. A failed transaction is retried up to RV8803_DEFAULT_RETRIES times,
+//waiting RV8803_DEFAULT_BACKOFF_US before the first retry and doubling the wait each time,
+//but never past RV8803_DEFAULT_DEADLINE_US from the start of the first attempt
+#define RV8803_DEFAULT_RETRIES				2
+#define RV8803_DEFAULT_BACKOFF_US			100
+#define RV8803_DEFAULT_DEADLINE_US			5000
+#define RV8803_NO_PIN						0xFF
+
+//setTimePrecise() takes the lock and reads CONTROL this long before the target instant, so that the write which
+//starts the clock is on time. Allow for a one byte read at your bus speed, plus any retries
+#ifndef RV8803_PRECISE_SET_LEAD_US
+#define RV8803_PRECISE_SET_LEAD_US			2000
+#endif
+
+//setToCompilerTime() adjustments, applied when the library is compiled. Override them with build flags.
+//RV8803_UPLOAD_LATENCY_SECONDS is added to allow for the time between compiling and the sketch starting.
+//RV8803_COMPILER_TIME_OFFSET_QUARTER_HOURS moves the time from the zone of the build machine into the
+//zone the RTC should keep, e.g. -24 if you build on a UTC server for an RTC on Mountain Daylight Time
+#ifndef RV8803_UPLOAD_LATENCY_SECONDS
+#define RV8803_UPLOAD_LATENCY_SECONDS		0
+#endif
+#ifndef RV8803_COMPILER_TIME_OFFSET_QUARTER_HOURS
+#define RV8803_COMPILER_TIME_OFFSET_QUARTER_HOURS	0
+#endif
+
+//Number of times updateTime() will read the time registers before giving up on a corrupt snapshot
+#define RV8803_SNAPSHOT_READ_ATTEMPTS		3
+
+//With time validity tracking enabled, updateTime() reads from hundredths up to and including the flag register
+#define RV8803_SNAPSHOT_WITH_FLAGS_LENGTH	(RV8803_FLAG - RV8803_HUNDREDTHS + 1)
+
 enum time_order {
 	TIME_HUNDREDTHS,	// 0
 	TIME_SECONDS,		// 1
@@ -138,6 +198,167 @@ enum time_order {
 	TIME_YEAR,			// 7
 };
 
+//Masks for setTimeFields(), one bit per time_order entry. Hundredths are read only
+#define TIME_FIELD_SECONDS					(1 << TIME_SECONDS)
+#define TIME_FIELD_MINUTES					(1 << TIME_MINUTES)
+#define TIME_FIELD_HOURS					(1 << TIME_HOURS)
+#define TIME_FIELD_WEEKDAY					(1 << TIME_WEEKDAY)
+#define TIME_FIELD_DATE						(1 << TIME_DATE)
+#define TIME_FIELD_MONTH					(1 << TIME_MONTH)
+#define TIME_FIELD_YEAR						(1 << TIME_YEAR)
+#define TIME_FIELD_ALL						0xFE
+
+//Result of a bus transaction. The first values match the endTransmission() return codes
+enum RV8803_Result {
+	RV8803_SUCCESS = 0,
+	RV8803_ERROR_DATA_TOO_LONG,		// 1 - Transmit buffer overflow
+	RV8803_ERROR_NACK_ADDRESS,		// 2 - NACK on transmit of address
+	RV8803_ERROR_NACK_DATA,			// 3 - NACK on transmit of data
+	RV8803_ERROR_BUS,				// 4 - Other bus error (lost arbitration, stuck bus)
+	RV8803_ERROR_TIMEOUT,			// 5 - Bus timeout (reported by some cores)
+	RV8803_ERROR_SHORT_READ,		// requestFrom() returned fewer bytes than requested
+	RV8803_ERROR_INVALID_ARGUMENT,	// Request rejected before touching the bus
+};
+
+//How far the time can be trusted, based on the V1F and V2F supply flags
+enum RV8803_TimeValidity {
+	RV8803_TIME_INVALID = 0,	// V2F: the supply dropped low enough for the time to be lost, or the flags have not been checked yet
+	RV8803_TIME_DEGRADED,		// V1F: temperature compensation stopped for a while, the time is less accurate
+	RV8803_TIME_TRUSTED,		// No supply problems since the time was last set
+};
+
+//Which path begin(profile) took
+enum RV8803_BootPath {
+	RV8803_BOOT_FAILED = 0,		// The RTC didn't answer, or a read or write failed
+	RV8803_BOOT_WARM,			// The RTC already matched the profile. Nothing was written
+	RV8803_BOOT_RECONFIGURED,	// The supply was fine but the configuration differed, so the differences were written
+	RV8803_BOOT_COLD,			// V2F was set (power-on reset or brown-out), so the profile was written. The time needs setting too
+};
+
+//Takes or gives the lock passed to setLockCallbacks()
+typedef void (*RV8803_LockCallback)(void *context);
+
+//Called on a second or minute boundary by serviceTimeUpdates()
+typedef void (*RV8803_TickCallback)(void);
+
+//Called by serviceInterrupts() for a flag that was set
+typedef void (*RV8803_InterruptHandler)(void);
+
+//Fixed-capacity string returned by value from the format...() functions. Needs no heap and no static
+//buffer, so results from different calls (or tasks) never overwrite each other. Converts to const char *
+//so it can be passed straight to Serial.print(), or use c_str() for printf().
+template <size_t N>
+struct RV8803_String
+{
+	char buffer[N];
+
+	const char *c_str() const { return buffer; }
+	operator const char *() const { return buffer; }
+	static size_t capacity() { return N; }
+};
+
+typedef RV8803_String<RV8803_DATE_STRING_LENGTH> RV8803_DateString;
+typedef RV8803_String<RV8803_TIME_STRING_LENGTH> RV8803_TimeString;
+typedef RV8803_String<RV8803_TIMESTAMP_STRING_LENGTH> RV8803_TimestampString;
+typedef RV8803_String<RV8803_TIME8601_STRING_LENGTH> RV8803_Time8601String;
+typedef RV8803_String<RV8803_TIME8601TZ_STRING_LENGTH> RV8803_Time8601TZString;
+typedef RV8803_String<RV8803_DAY_STRING_LENGTH> RV8803_DayString;
+typedef RV8803_String<RV8803_DAY_SHORT_STRING_LENGTH> RV8803_DayShortString;
+typedef RV8803_String<RV8803_ORDINAL_STRING_LENGTH> RV8803_OrdinalString;
+typedef RV8803_String<RV8803_MONTH_STRING_LENGTH> RV8803_MonthString;
+typedef RV8803_String<RV8803_MONTH_SHORT_STRING_LENGTH> RV8803_MonthShortString;
+
+//A decoded copy of the time registers, for working out intervals without touching the bus or the epoch.
+//Fields are plain decimal. Differences are in hundredths of a second, which fits about 248 days in an int32_t.
+struct RV8803_Snapshot
+{
+	uint8_t hundredths;
+	uint8_t seconds;
+	uint8_t minutes;
+	uint8_t hours; //Always 24 hour
+	uint8_t weekday; //0 = Sunday, 6 = Saturday
+	uint8_t date;
+	uint8_t month; //0 if the snapshot was never filled in
+	uint16_t year;
+
+	static RV8803_Snapshot fromTime(const uint8_t * time); //Decode a TIME_ARRAY_LENGTH BCD array
+	void toTime(uint8_t * time) const; //Encode back into a TIME_ARRAY_LENGTH BCD array
+	bool isSet() const;
+
+	int32_t hundredthsSince(const RV8803_Snapshot &earlier) const; //this - earlier. Saturates at INT32_MAX / INT32_MIN
+	int8_t compare(const RV8803_Snapshot &other) const; //-1 if this is earlier than other, 0 if the same, 1 if later
+	bool addHundredths(int32_t hundredths); //Move by +/- hundredths, carrying into the date. False (and unchanged) if the result is outside 2000-2099
+};
+
+//Everything that configures the RV8803, as read by readConfig(): RAM (time zone), the alarm, timer, extension, flag
+//and control registers (0x07 to 0x0F) and the offset and event control registers. Store one in flash as a golden
+//profile and writeConfig() it, or compare a device with it using diffConfig()
+#define RV8803_CONFIG_VERSION				1
+#define RV8803_CONFIG_LENGTH				11
+
+//Indexes into RV8803_Config::registers
+#define CONFIG_RAM							0
+#define CONFIG_MINUTES_ALARM				1
+#define CONFIG_HOURS_ALARM					2
+#define CONFIG_WEEKDAYS_DATE_ALARM			3
+#define CONFIG_TIMER_0						4
+#define CONFIG_TIMER_1						5
+#define CONFIG_EXTENSION					6
+#define CONFIG_FLAG							7 //Read for information only, never written back
+#define CONFIG_CONTROL						8
+#define CONFIG_OFFSET						9
+#define CONFIG_EVENT_CONTROL				10
+
+struct RV8803_Config
+{
+	uint8_t version;
+	uint8_t registers[RV8803_CONFIG_LENGTH];
+	uint8_t crc; //CRC-8 of version and registers
+
+	bool isValid() const; //Right version and CRC
+	void updateCRC(); //Call after changing registers by hand
+};
+
+//Streaming NMEA 0183 parser which pulls UTC time and date out of RMC or ZDA sentences from any GNSS module.
+//Feed it characters with process() or update(stream); when either returns true, a sentence with a good
+//checksum and a valid time and date has just finished and can be passed to RV8803::setTimeFromNMEA().
+//Uses about 40 bytes of RAM.
+#define RV8803_NMEA_FIELD_LENGTH			12 //Longest field we need is hhmmss.sss
+
+class RV8803_NMEA
+{
+public:
+	bool process(char c); //Feed one character. Returns true when a new time has been completed
+	bool update(Stream &stream); //Feed every character available on stream. Returns true if a new time was completed
+	bool getTime(uint8_t * time) const; //Copy the latest UTC time into a TIME_ARRAY_LENGTH BCD array. Returns false if there is none yet
+	uint32_t getTimeMillis() const; //millis() when the latest time was completed
+	uint32_t getSentenceCount() const; //Number of RMC/ZDA sentences with a valid time
+	uint32_t getChecksumErrorCount() const;
+
+private:
+	enum ParseState { WAIT_FOR_START, IN_SENTENCE, IN_CHECKSUM };
+	enum SentenceType { OTHER_SENTENCE, RMC_SENTENCE, ZDA_SENTENCE };
+
+	void endField();
+	bool endSentence();
+
+	ParseState _state = WAIT_FOR_START;
+	SentenceType _type = OTHER_SENTENCE;
+	uint8_t _fieldIndex = 0;
+	char _field[RV8803_NMEA_FIELD_LENGTH + 1];
+	uint8_t _fieldLength = 0;
+	uint8_t _checksum = 0;
+	uint8_t _receivedChecksum = 0;
+	uint8_t _checksumDigits = 0;
+
+	uint8_t _pending[TIME_ARRAY_LENGTH]; //Time from the sentence being parsed
+	uint8_t _pendingFields = 0; //Bit mask of what the sentence has provided so far
+	uint8_t _time[TIME_ARRAY_LENGTH] = { 0 }; //Latest complete time. Month 0 = none yet
+	uint32_t _timeMillis = 0;
+	uint32_t _sentences = 0;
+	uint32_t _checksumErrors = 0;
+};
+
 class RV8803
 {
 public:
@@ -145,6 +366,13 @@ public:
 	RV8803( void );
 
 	bool begin(TwoWire &wirePort = Wire);
+	RV8803_BootPath begin(const RV8803_Config &profile, TwoWire &wirePort = Wire); //begin(), then bring the RTC into line with profile with as little bus traffic as possible
+
+	void setRetryPolicy(uint8_t maxRetries, uint16_t initialBackoffMicros = RV8803_DEFAULT_BACKOFF_US, uint32_t deadlineMicros = RV8803_DEFAULT_DEADLINE_US); //Retries with exponential backoff, capped by a deadline
+	void setBusRecoveryPins(uint8_t sclPin, uint8_t sdaPin); //Clock SCL to free a stuck SDA line before each retry. Pass RV8803_NO_PIN to disable
+	void setBusRecoveryCallback(void (*recoverBus)(TwoWire &wirePort)); //User-supplied recovery, called before each retry
+	RV8803_Result getLastError(); //Result of the most recent bus transaction
+	void setLockCallbacks(RV8803_LockCallback lock, RV8803_LockCallback unlock, void *context = nullptr); //Lock a shared TwoWire port around each operation. The lock must be recursive
 	
 	void set12Hour();
 	void set24Hour();
@@ -173,12 +401,32 @@ public:
 	char *stringMonth(); //Return the name of the month. Returns "January", etc
 	char *stringMonthShort(char *buffer, size_t len); //Return the name of the month (short). Returns "Jan", "Feb" etc
 	char *stringMonthShort(); //Return the name of the month (short). Returns "Jan", "Feb" etc
+
+	//Reentrant versions of the string functions above, returning the text by value
+	RV8803_DateString formatDateUSA(); //mm/dd/yyyy
+	RV8803_DateString formatDate(); //dd/mm/yyyy
+	RV8803_TimeString formatTime(); //hh:mm:ss with AM/PM if in 12 hour mode
+	RV8803_TimestampString formatTimestamp(); //hh:mm:ss:hh
+	RV8803_Time8601String formatTime8601(); //yyyy-mm-ddThh:mm:ss
+	RV8803_Time8601TZString formatTime8601TZ(); //yyyy-mm-ddThh:mm:ss+/-hh:mm
+	RV8803_DayString formatDayOfWeek(); //"Sunday" etc
+	RV8803_DayShortString formatDayOfWeekShort(); //"Sun" etc
+	RV8803_OrdinalString formatDateOrdinal(); //"1st", "2nd" etc
+	RV8803_MonthString formatMonth(); //"January" etc
+	RV8803_MonthShortString formatMonthShort(); //"Jan" etc
 		
 	bool setTime(uint8_t sec, uint8_t min, uint8_t hour, uint8_t weekday, uint8_t date, uint8_t month, uint16_t year);
 	bool setTime(uint8_t * time, uint8_t len = TIME_ARRAY_LENGTH);
-	bool setEpoch(uint32_t value, bool use1970sEpoch = false, int8_t timeZoneQuarterHours = 0); // If timeZoneQuarterHours is non-zero, update RV8803_RAM. Add the zone to the epoch before setting
-	bool setLocalEpoch(uint32_t value, bool use1970sEpoch = false); // Set the local epoch - without adding the time zone
+	bool setEpoch(uint32_t value, bool use1970sEpoch = false, int8_t timeZoneQuarterHours = 0); // value counts from 1970 if use1970sEpoch, else from the platform's time_t epoch (2000 on AVR, 1970 elsewhere), as getEpoch() returns it. If timeZoneQuarterHours is non-zero, update RV8803_RAM. Add the zone to the epoch before setting. False if the local time is outside 2000-2099
+	bool setLocalEpoch(uint32_t value, bool use1970sEpoch = false); // Set the local epoch - without adding the time zone. value counts from the same epoch as setEpoch()
+	bool setTimeFields(uint8_t fieldMask, const uint8_t * time); //Write only the masked fields of a TIME_ARRAY_LENGTH BCD array, one burst per contiguous run
 	bool setHundredthsToZero();
+	bool setTimePrecise(const uint8_t * time, uint32_t fireAtMicros, int8_t * skewHundredths = nullptr); //Hold the clock in reset, write time, and start it at micros() == fireAtMicros. Optionally report the residual skew
+	bool setTime8601(const char * iso8601); //Set the time (and time zone, if the string has one) from yyyy-mm-ddThh:mm:ss[.ss][Z|+/-hh:mm]
+	static bool parseTime8601(const char * iso8601, uint8_t * time, int8_t &timeZoneQuarterHours, bool &hasTimeZone); //Parse into a TIME_ARRAY_LENGTH BCD array without touching the RTC
+	static uint8_t dayOfWeek(uint16_t year, uint8_t month, uint8_t date); //0 = Sunday, 6 = Saturday
+	bool setTimeFromNMEA(const RV8803_NMEA &nmea, uint8_t ppsPin = RV8803_NO_PIN, uint16_t ppsTimeoutMillis = 1100); //Set from the latest NMEA time, converted to the local time zone. With a PPS pin, start the next second on its rising edge
+	static bool addSecondsToTime(uint8_t * time, int32_t seconds); //Add (or subtract) seconds to a BCD time array, carrying into the date. False if the result is outside 2000-2099
 	bool setSeconds(uint8_t value);
 	bool setMinutes(uint8_t value);
 	bool setHours(uint8_t value);
@@ -186,10 +434,21 @@ public:
 	bool setWeekday(uint8_t value);
 	bool setMonth(uint8_t value);
 	bool setYear(uint16_t value);
-	void setTimeZoneQuarterHours(int8_t quarterHours); // Write the time zone to RV8803_RAM as int8_t (signed) in 15 minute increments
+	bool setTimeZoneQuarterHours(int8_t quarterHours); // Write the time zone to RV8803_RAM as int8_t (signed) in 15 minute increments
 	int8_t getTimeZoneQuarterHours(void); // Read RV8803_RAM (int8_t (signed))
 
 	bool updateTime(); //Update the local array with the RTC registers
+	bool readTime(uint8_t * time, int8_t &quarterHours); //Read the RTC into time (TIME_ARRAY_LENGTH bytes) and the time zone, leaving the local array alone
+	static bool isValidTime(const uint8_t * time); //Check a TIME_ARRAY_LENGTH snapshot for legal BCD, field ranges, one-hot weekday and a date that exists
+	uint32_t getRejectedSnapshotCount(); //Number of snapshots updateTime() has thrown away as corrupt
+	uint32_t getSnapshotCount(); //Number of calls to updateTime() and readTime()
+	uint32_t getSnapshotRetryCount(); //Number of updateTime() and readTime() calls which needed a second read because of a rollover
+	RV8803_Snapshot getSnapshot(); //The time read by the last updateTime(), decoded. No bus traffic
+
+	//A steady clock for measuring durations. It follows the RTC between snapshots (extrapolated with millis()) but
+	//does not jump when the time is set through the library, and it never goes backwards
+	uint64_t getMonotonicMillis();
+	uint64_t getMonotonicHundredths();
 
 	uint8_t getHundredths();
 	uint8_t getSeconds();
@@ -199,16 +458,38 @@ public:
 	uint8_t getWeekday();
 	uint8_t getMonth();
 	uint16_t getYear();	
-	uint32_t getEpoch(bool use1970sEpoch = false); // Get the epoch - with the time zone subtracted (i.e. return UTC epoch)
-	uint32_t getLocalEpoch(bool use1970sEpoch = false); // Get the local epoch - without subtracting the time zone
+	uint32_t getEpoch(bool use1970sEpoch = false); // Get the epoch - with the time zone subtracted (i.e. return UTC epoch). Counts from the same epoch as setEpoch(): 1970 if use1970sEpoch, else the platform's time_t epoch (2000 on AVR, 1970 elsewhere)
+	uint32_t getLocalEpoch(bool use1970sEpoch = false); // Get the local epoch - without subtracting the time zone. Counts from the same epoch as getEpoch()
+
+	void enableTimeValidityTracking(bool enable = true); //Make updateTime() read the flag register in the same burst and track V1F/V2F
+	bool checkTimeValidity(); //Read the flag register once and update the validity state
+	RV8803_TimeValidity getTimeValidity(); //Trusted, degraded or invalid. Only a setTime/setEpoch through the library makes the time trusted again
+	bool getValidEpoch(uint32_t &epoch, bool use1970sEpoch = false); //As getEpoch, but returns false (and no epoch) while the time is invalid
+	uint32_t getLastTrustedEpoch(bool use1970sEpoch = false); //UTC epoch of the last snapshot taken while the time was trusted, 0 if none
 	
 	uint8_t getHundredthsCapture();
 	uint8_t getSecondsCapture();
 	
 	bool setToCompilerTime(); //Uses the hours, mins, etc from compile time to set RTC
+	static uint32_t getCompilerEpoch(); //Seconds since 1970 of the local time setToCompilerTime() writes
 	
+#ifndef RV8803_NO_FLOAT //Define RV8803_NO_FLOAT to leave out every floating point function
 	bool setCalibrationOffset(float ppm);
 	float getCalibrationOffset();
+#endif
+	bool setCalibrationOffsetPPB(int32_t ppb); //Rounded to the nearest 238.4 ppb step. Positive slows the clock. False if that is outside -32 to +31 steps (about -7.6 to +7.4 ppm)
+	int32_t getCalibrationOffsetPPB(); //Rounded to the nearest ppb
+
+	//Slew the time instead of stepping it, like adjtime(): the OFFSET register is pushed to its limit (at most ~15 ppm
+	//away from the calibration) until the correction has built up, then the calibration is put back.
+	//Call serviceSlew() regularly from loop(). Don't change the calibration offset while a slew is running
+	bool startSlew(int32_t correctionMillis); //Positive moves the time forward (the RTC is behind)
+	bool serviceSlew(); //Restores the calibration when the slew is done. False on a bus error
+	bool stopSlew(); //Restore the calibration now, leaving the correction part done
+	bool isSlewing();
+	uint32_t getSlewDurationMillis(); //How long the whole correction takes
+	uint32_t getSlewRemainingMillis();
+	int32_t getSlewRemainingCorrectionMillis(); //How much of the correction is still to be applied
 	
 	bool setEVICalibration(bool eviCalibration);
 	bool setEVIDebounceTime(uint8_t debounceTime);
@@ -228,13 +509,19 @@ public:
 	uint8_t getClockOutTimerFrequency();
 		
 	bool getCountdownTimerEnable();
-	uint16_t getCountdownTimerClockTicks();
+	uint16_t getCountdownTimerClockTicks(); //The preset: the RTC can't read back the count
 	uint8_t getCountdownTimerFrequency();
+	bool getCountdownTimerRemainingMillis(uint32_t &remainingMillis); //Time until the timer next fires. False if it is stopped, or wasn't started by setCountdownTimerEnable() since the last time set
+	bool getCountdownTimerExpiryEpoch(uint32_t &epoch); //UTC epoch (since 1970, like getEpoch(true)) when the timer next fires, to the nearest second. False as above
 	
 	bool setPeriodicTimeUpdateFrequency(bool timeUpdateFrequency);
 	bool getPeriodicTimeUpdateFrequency();
+
+	void onSecond(RV8803_TickCallback callback); //Call callback every second. Sets the update frequency to TIME_UPDATE_1_SECOND. Pass nullptr to unsubscribe
+	void onMinute(RV8803_TickCallback callback); //Call callback every minute. Works with either update frequency. Pass nullptr to unsubscribe
+	bool serviceTimeUpdates(); //Read the flag register once and call the subscribers if the UPDATE flag is set. Returns true on a tick
 	
-	void setItemsToMatchForAlarm(bool minuteAlarm, bool hourAlarm, bool weekdayAlarm, bool dateAlarm); //0 to 7, alarm goes off with match of second, minute, hour, etc
+	bool setItemsToMatchForAlarm(bool minuteAlarm, bool hourAlarm, bool weekdayAlarm, bool dateAlarm); //0 to 7, alarm goes off with match of second, minute, hour, etc
 	bool setAlarmMinutes(uint8_t minute);
 	bool setAlarmHours(uint8_t hour);
 	bool setAlarmWeekday(uint8_t weekday);
@@ -244,6 +531,7 @@ public:
 	uint8_t getAlarmHours();
 	uint8_t getAlarmWeekday();
 	uint8_t getAlarmDate();
+	bool getNextAlarmEpoch(uint32_t &epoch); //UTC epoch (since 1970, like getEpoch(true)) when the alarm will next go off after the last updateTime(). False if the alarm is disabled or can never match, or if there is no successful updateTime() to start from
 
 	bool enableHardwareInterrupt(uint8_t source); //Enables a given interrupt within Interrupt Enable register
 	bool disableHardwareInterrupt(uint8_t source); //Disables a given interrupt within Interrupt Enable register
@@ -252,10 +540,15 @@ public:
 	bool getInterruptFlag(uint8_t flagToGet);
 	bool clearInterruptFlag(uint8_t flagToClear);
 	bool clearAllInterruptFlags();
+	bool clearInterruptFlags(uint8_t flagMask); //Clear every flag whose bit is set in flagMask, in one write
+
+	bool attachInterruptHandler(uint8_t flag, RV8803_InterruptHandler handler); //flag is FLAG_UPDATE, FLAG_TIMER, FLAG_ALARM, FLAG_EVI, FLAG_V2F or FLAG_V1F
+	bool detachInterruptHandler(uint8_t flag);
+	uint8_t serviceInterrupts(); //Read the flags once, clear and dispatch every one with a handler. Returns the mask of handled flags
 		
 	//Values in RTC are stored in Binary Coded Decimal. These functions convert to/from Decimal
-	uint8_t BCDtoDEC(uint8_t val); 
-	uint8_t DECtoBCD(uint8_t val);
+	static uint8_t BCDtoDEC(uint8_t val);
+	static uint8_t DECtoBCD(uint8_t val);
 
 	bool readBit(uint8_t regAddr, uint8_t bitAddr);
 	uint8_t readTwoBits(uint8_t regAddr, uint8_t bitAddr);
@@ -266,6 +559,27 @@ public:
 	bool readMultipleRegisters(uint8_t addr, uint8_t * dest, uint8_t len);
 	bool writeMultipleRegisters(uint8_t addr, uint8_t * values, uint8_t len);
 
+	bool readConfig(RV8803_Config &config); //Two burst reads
+	bool writeConfig(const RV8803_Config &config); //Writes only the registers which differ, in bursts. Never writes FLAG or sets RESET
+	bool diffConfig(const RV8803_Config &config, uint16_t &differences); //Bit n set if register CONFIG_n differs. FLAG is ignored
+
+	//Result-returning register access. Failed transactions are retried according to the retry policy
+	RV8803_Result tryReadRegister(uint8_t addr, uint8_t &value);
+	RV8803_Result tryWriteRegister(uint8_t addr, uint8_t val);
+	RV8803_Result tryReadMultipleRegisters(uint8_t addr, uint8_t * dest, uint8_t len);
+	RV8803_Result tryWriteMultipleRegisters(uint8_t addr, const uint8_t * values, uint8_t len);
+	bool recoverBus(); //Run the configured bus recovery now
+
+	//Bus trace recorder. Every transaction is logged into a ring buffer you provide; when it is full the oldest
+	//records are dropped. Each record is 7 bytes plus the data: flags (bit 7 set for a write, bits 2:0 the
+	//RV8803_Result), register address, length, micros() little-endian, then the bytes written or read
+	//(none for a read that failed). exportTrace() writes "RV88", a version byte and the records oldest first
+	void setTraceBuffer(uint8_t * buffer, uint16_t size); //nullptr to stop tracing
+	void clearTrace();
+	uint16_t getTraceRecordCount();
+	uint32_t getTraceDroppedCount(); //Records dropped to make room, or too big for the buffer
+	size_t exportTrace(Print &output); //Returns the number of bytes written
+
 	// When converting from a UTC based struct tm to a time_t value, you would normally use a utc
 	// version of mktime - timegm(), but we don't have that on most micro controllers - so use 
 	// the following. 
@@ -273,7 +587,118 @@ public:
 	time_t _timegm(struct tm *tm, bool use1970sEpoch);
 
   private:
-	uint8_t _time[TIME_ARRAY_LENGTH];
+	//Holds the user's lock (if any) for as long as it is in scope
+	class BusLock
+	{
+	public:
+		BusLock(RV8803 &rtc) : _rtc(rtc) { if (_rtc._lock != nullptr) _rtc._lock(_rtc._lockContext); }
+		~BusLock() { if (_rtc._unlock != nullptr) _rtc._unlock(_rtc._lockContext); }
+	private:
+		RV8803 &_rtc;
+	};
+
+	bool setTimeField(uint8_t field, uint8_t bcdValue);
+	bool stagePreciseSet(const uint8_t * time);
+	bool releasePreciseSet(uint32_t releaseAtMicros);
+	RV8803_Result readRegistersOnce(uint8_t addr, uint8_t * dest, uint8_t len);
+	RV8803_Result writeRegistersOnce(uint8_t addr, const uint8_t * values, uint8_t len);
+	bool waitBeforeRetry(uint8_t attempt, uint32_t startMicros, uint16_t &backoffMicros);
+
+	uint8_t _time[TIME_ARRAY_LENGTH] = { 0 }; //Month 0 = no time yet, which isValidTime() rejects
+	bool _timeStale = true; //No updateTime() yet, or the last one failed
 	bool _isTwelveHour = true;
 	TwoWire *_i2cPort;
+	uint32_t _rejectedSnapshots = 0;
+	bool readSnapshot(uint8_t * snapshot, uint8_t len);
+	uint32_t _snapshotReads = 0;
+	uint32_t _snapshotRetries = 0;
+
+	void countTimeUpdate(bool &second, bool &minute);
+	void dispatchTimeUpdate(bool second, bool minute);
+	RV8803_TickCallback _onSecond = nullptr;
+	RV8803_TickCallback _onMinute = nullptr;
+	uint8_t _updateFrequency = 0xFF; //Cached EXTENSION_USEL, 0xFF = not read yet
+	uint8_t _tickSeconds = 0xFF; //Seconds counted from the update ticks, 0xFF = not known yet
+	RV8803_InterruptHandler _interruptHandlers[FLAG_UPDATE + 1] = { nullptr };
+
+	uint32_t epochFromTime(const uint8_t * time, bool use1970sEpoch);
+	uint32_t localEpochFromTime(const uint8_t * time, bool use1970sEpoch);
+	bool setTimeFromEpoch(uint32_t value, bool use1970sEpoch, int32_t offsetSeconds);
+	bool countdownRemainingMillis(const uint8_t * time, uint32_t &remainingMillis);
+	bool _timerStartKnown = false; //Set when setCountdownTimerEnable() starts the timer; cleared by a time set
+	int64_t _timerStartMillis = 0; //RTC time in ms since 2000-01-01 when the timer was started
+	bool writeConfigChanges(RV8803_Config &current, const RV8803_Config &config);
+	static uint16_t configDifferences(const RV8803_Config &current, const RV8803_Config &config);
+
+	void noteClock(const uint8_t * time, bool stepped);
+	bool _clockKnown = false;
+	int64_t _clockMillis = 0; //RTC time in ms since 2000-01-01, at _clockMillisAt
+	uint32_t _clockMillisAt = 0; //millis() when _clockMillis was read or written
+	bool _clockStepPending = false; //setTimeFields() changed the time; the next snapshot is a step, not drift
+	int64_t _monotonicOffset = 0; //Monotonic time - RTC time
+	uint64_t _monotonicLast = 0;
+
+	bool _slewing = false;
+	uint8_t _slewBaseline = 0; //OFFSET register before the slew
+	int32_t _slewCorrectionMillis = 0;
+	uint32_t _slewDurationMillis = 0;
+	uint32_t _slewElapsedMillis = 0;
+	uint32_t _slewLastMillis = 0;
+	void noteSupplyFlags(uint8_t flags);
+	bool markTimeSet();
+	bool _trackValidity = false;
+	RV8803_TimeValidity _validity = RV8803_TIME_INVALID;
+	bool _validityChecked = false;
+	uint8_t _lastTrustedTime[TIME_ARRAY_LENGTH] = { 0 }; //Month 0 = no trusted snapshot yet
+
+	uint8_t _maxRetries = RV8803_DEFAULT_RETRIES;
+	uint16_t _initialBackoffMicros = RV8803_DEFAULT_BACKOFF_US;
+	uint32_t _deadlineMicros = RV8803_DEFAULT_DEADLINE_US;
+	uint8_t _sclPin = RV8803_NO_PIN;
+	uint8_t _sdaPin = RV8803_NO_PIN;
+	void (*_recoverBus)(TwoWire &wirePort) = nullptr;
+	RV8803_Result _lastError = RV8803_SUCCESS;
+	RV8803_LockCallback _lock = nullptr;
+	RV8803_LockCallback _unlock = nullptr;
+	void *_lockContext = nullptr;
+
+	void traceTransaction(bool write, uint8_t addr, const uint8_t * data, uint8_t len, RV8803_Result result);
+	void traceByte(uint8_t value);
+	uint8_t * _traceBuffer = nullptr;
+	uint16_t _traceSize = 0;
+	uint16_t _traceHead = 0; //Next byte to write
+	uint16_t _traceTail = 0; //Oldest record
+	uint16_t _traceUsed = 0;
+	uint16_t _traceRecords = 0;
+	uint32_t _traceDropped = 0;
 };
+
+#ifdef RV8803_HAS_CHRONO
+//A std::chrono clock backed by an RV8803, counting hundredths of a second since 1970-01-01 UTC (like system_clock).
+//now() is served from the last snapshot, extrapolated with millis(). The RTC is only read again (readTime(), which
+//leaves the RV8803's own snapshot alone) once the snapshot is more than stalenessMillis old, so calling now() in a
+//loop costs no bus traffic.
+class RV8803_Clock
+{
+public:
+	typedef std::chrono::duration<int64_t, std::centi> duration;
+	typedef duration::rep rep;
+	typedef duration::period period;
+	typedef std::chrono::time_point<RV8803_Clock> time_point;
+	static constexpr bool is_steady = false;
+
+	static void attach(RV8803 &rtc, uint32_t stalenessMillis = 1000); //Call once before now()
+	static time_point now(); //The epoch (time_point()) until the RTC has been read successfully
+	static void invalidate(); //Make the next now() read the RTC, e.g. after setting the time
+
+	static std::chrono::system_clock::time_point to_sys(const time_point &t);
+	static time_point from_sys(const std::chrono::system_clock::time_point &t);
+
+private:
+	static RV8803 *_rtc;
+	static uint32_t _stalenessMillis;
+	static bool _haveSnapshot;
+	static int64_t _snapshotHundredths; //UTC hundredths since 1970 at _snapshotMillis
+	static uint32_t _snapshotMillis;
+};
+#endif
@@ -0,0 +1,62 @@
+/*
+  Just enough of the Arduino core to build the library on a desktop compiler for the tests in test/.
+  Time is simulated: it only moves when the tests (or the library, through delay() and friends) move it.
+*/
+
+#ifndef RV8803_MOCK_ARDUINO_H
+#define RV8803_MOCK_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+uint32_t millis();
+uint32_t micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// Test controls for the simulated time base
+uint64_t simMicros();
+void simAdvanceMicros(uint64_t us);
+extern uint32_t simMicrosPerCall; // How far each call to micros() or millis() moves time, so polling loops end
+extern uint8_t simPulsePin; // digitalRead() of this pin gives a 100 ms pulse every second, like a GNSS PPS output
+extern uint32_t simPulseOffsetMicros; // Where the pulses start in each second of simMicros(). Other pins read HIGH
+
+class Print
+{
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t value) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size)
+	{
+		size_t written = 0;
+		while (size--)
+			written += write(*buffer++);
+		return written;
+	}
+};
+
+class Stream : public Print
+{
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+};
+
+#endif
@@ -0,0 +1,70 @@
+/*
+  A TwoWire with a simulated RV-8803 on the other end, for the tests in test/.
+
+  The simulated RTC counts hundredths from simMicros(), with the calendar carries, leap years and weekday rotation
+  of the real part. Like the real part it doesn't update the time registers while a transaction is in progress, so
+  every burst is coherent; time only moves between transactions. A test can set tickBetweenBytes to let the clock
+  run between the bytes of a read, so that the library's defences against torn bursts are exercised. Registers 0x00-0x06 and 0x08-0x0F mirror
+  0x11-0x17 and 0x18-0x1F, writing the seconds clears the hundredths, FLAG bits can only be cleared and
+  CONTROL.RESET holds the time at the start of a second until it is cleared. The update flag is set at every
+  second, or every minute with EXTENSION.USEL. The countdown timer counts from the preset in TIMER_0 and TIMER_1 when
+  EXTENSION.TE goes from 0 to 1, clocked as EXTENSION.TD selects, sets FLAG.TF and reloads each time it reaches zero;
+  like the real part, reading the timer registers returns the preset, not the count.
+*/
+
+#ifndef RV8803_MOCK_WIRE_H
+#define RV8803_MOCK_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire : public Stream
+{
+public:
+	TwoWire();
+
+	void begin() {}
+	void beginTransmission(uint8_t address);
+	uint8_t endTransmission(bool sendStop = true);
+	uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+	size_t write(uint8_t value) override;
+	int available() override { return _rxLength - _rxIndex; }
+	int read() override { return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex++] : -1; }
+	int peek() override { return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex] : -1; }
+
+	// Test controls
+	void reset(); //Power on: all registers zero, the time 2000-01-01 00:00:00.00 Saturday
+	void setClock(uint16_t year, uint8_t month, uint8_t date, uint8_t hour, uint8_t minute, uint8_t second, uint8_t hundredths);
+	int64_t getClockHundredths(); //Hundredths since 2000-01-01 00:00:00.00, as the registers hold now
+	uint8_t peekRegister(uint8_t addr); //Without a transaction, and without moving the clock
+	void pokeRegister(uint8_t addr, uint8_t value);
+	uint8_t canonical(uint8_t addr); //addr, or the register it mirrors if it is one of 0x00-0x06 or 0x08-0x0F
+
+	uint8_t failNext = 0; //Fail this many transactions with a NACK
+	bool tickBetweenBytes = false; //Let the clock run while a read burst is in progress, unlike the real part, so bursts can tear
+	void (*beforeRead)(uint8_t reg) = nullptr; //Called at the start of every read with its first register, before the clock catches up
+	uint32_t transactions = 0;
+	uint32_t bytes = 0; //Every byte on the bus, address bytes included
+
+private:
+	void catchUp(); //Run the clock up to simMicros()
+	void tick(); //One hundredth
+	void timerTicks(uint64_t count); //count periods of the countdown timer clock
+
+	uint8_t _regs[0x30];
+	uint64_t _lastMicros = 0;
+	uint32_t _prescaler = 0; //Microseconds into the current hundredth
+	uint16_t _timerCount = 0; //Countdown timer periods left until it fires
+	uint64_t _timerPhase = 0; //Microseconds x timer clock Hz into the current 4096 Hz or 64 Hz period
+	bool _transmitting = false;
+	bool _haveAddress = false;
+	uint8_t _pointer = 0;
+	uint8_t _txBuffer[32];
+	uint8_t _txLength = 0;
+	uint8_t _rxBuffer[32];
+	uint8_t _rxLength = 0;
+	uint8_t _rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,341 @@
+/*
+  The simulated time base and RV-8803 behind test/mock/Arduino.h and test/mock/Wire.h.
+*/
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#include <atomic>
+
+#define SIM_ADDR		0x32
+#define SIM_HUNDREDTHS	0x10
+#define SIM_SECONDS		0x11
+#define SIM_MINUTES		0x12
+#define SIM_HOURS		0x13
+#define SIM_WEEKDAYS	0x14
+#define SIM_DATE		0x15
+#define SIM_MONTHS		0x16
+#define SIM_YEARS		0x17
+#define SIM_TIMER_0		0x1B
+#define SIM_TIMER_1		0x1C
+#define SIM_EXTENSION	0x1D
+#define SIM_FLAG		0x1E
+#define SIM_CONTROL		0x1F
+
+#define SIM_EXTENSION_USEL	0x20 // Update flag once a minute instead of every second
+#define SIM_EXTENSION_TE	0x10
+#define SIM_EXTENSION_TD	0x03 // Timer clock: 4096 Hz, 64 Hz, 1 Hz (the seconds) or 1/60 Hz (the minutes)
+#define SIM_FLAG_UF			0x20
+#define SIM_FLAG_TF			0x10
+
+// A transaction at 400 kHz: start, address, the bytes and stop, about 25 us a byte
+#define SIM_MICROS_PER_BYTE	25
+
+static std::atomic<uint64_t> currentMicros(0); // Threads can share the time; a TwoWire is only safe to share under a lock
+uint32_t simMicrosPerCall = 1;
+uint8_t simPulsePin = 0xFF;
+uint32_t simPulseOffsetMicros = 0;
+
+TwoWire Wire;
+
+uint64_t simMicros()
+{
+    return currentMicros;
+}
+
+void simAdvanceMicros(uint64_t us)
+{
+    currentMicros += us;
+}
+
+uint32_t micros()
+{
+    return (uint32_t)(currentMicros += simMicrosPerCall);
+}
+
+uint32_t millis()
+{
+    return (uint32_t)((currentMicros += simMicrosPerCall) / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    currentMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    currentMicros += us;
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t, uint8_t)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin == simPulsePin)
+        return (((currentMicros + 1000000 - simPulseOffsetMicros) % 1000000) < 100000) ? HIGH : LOW;
+    return HIGH; // The bus is never stuck
+}
+
+static uint8_t toBCD(uint8_t val)
+{
+    return ((val / 10) << 4) | (val % 10);
+}
+
+static uint8_t fromBCD(uint8_t val)
+{
+    return ((val >> 4) * 10) + (val & 0x0F);
+}
+
+static uint8_t daysInMonth(uint8_t month, uint8_t year)
+{
+    static const uint8_t days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if ((month == 2) && ((year % 4) == 0))
+        return 29;
+    return days[month - 1];
+}
+
+TwoWire::TwoWire()
+{
+    reset();
+}
+
+void TwoWire::reset()
+{
+    memset(_regs, 0, sizeof(_regs));
+    tickBetweenBytes = false;
+    beforeRead = nullptr;
+    _regs[SIM_WEEKDAYS] = 1 << 6; // 2000-01-01 was a Saturday
+    _regs[SIM_DATE] = 0x01;
+    _regs[SIM_MONTHS] = 0x01;
+    _lastMicros = currentMicros;
+    _prescaler = 0;
+    _timerCount = 0;
+    _timerPhase = 0;
+    failNext = 0;
+}
+
+void TwoWire::setClock(uint16_t year, uint8_t month, uint8_t date, uint8_t hour, uint8_t minute, uint8_t second, uint8_t hundredths)
+{
+    catchUp();
+    // Zeller's congruence, counted so that 0 is Sunday
+    uint16_t y = (month < 3) ? year - 1 : year;
+    uint8_t m = (month < 3) ? month + 12 : month;
+    uint8_t weekday = (date + ((13 * (m + 1)) / 5) + y + (y / 4) - (y / 100) + (y / 400) + 6) % 7;
+
+    _regs[SIM_HUNDREDTHS] = toBCD(hundredths);
+    _regs[SIM_SECONDS] = toBCD(second);
+    _regs[SIM_MINUTES] = toBCD(minute);
+    _regs[SIM_HOURS] = toBCD(hour);
+    _regs[SIM_WEEKDAYS] = 1 << weekday;
+    _regs[SIM_DATE] = toBCD(date);
+    _regs[SIM_MONTHS] = toBCD(month);
+    _regs[SIM_YEARS] = toBCD(year - 2000);
+    _prescaler = 0;
+}
+
+int64_t TwoWire::getClockHundredths()
+{
+    catchUp();
+    int32_t year = fromBCD(_regs[SIM_YEARS]);
+    int64_t days = (year * 365) + ((year + 3) / 4); // Days before this year; 2000 was a leap year
+    for (uint8_t month = 1; month < fromBCD(_regs[SIM_MONTHS]); month++)
+        days += daysInMonth(month, year);
+    days += fromBCD(_regs[SIM_DATE]) - 1;
+    int64_t seconds = (days * 86400) + (fromBCD(_regs[SIM_HOURS]) * 3600) + (fromBCD(_regs[SIM_MINUTES]) * 60) + fromBCD(_regs[SIM_SECONDS]);
+    return (seconds * 100) + fromBCD(_regs[SIM_HUNDREDTHS]);
+}
+
+uint8_t TwoWire::peekRegister(uint8_t addr)
+{
+    return _regs[canonical(addr)];
+}
+
+void TwoWire::pokeRegister(uint8_t addr, uint8_t value)
+{
+    _regs[canonical(addr)] = value;
+}
+
+uint8_t TwoWire::canonical(uint8_t addr)
+{
+    if (addr <= 0x06)
+        return addr + SIM_SECONDS;
+    if ((addr >= 0x08) && (addr <= 0x0F))
+        return addr + 0x10;
+    return addr % sizeof(_regs);
+}
+
+void TwoWire::catchUp()
+{
+    uint64_t elapsed = currentMicros - _lastMicros;
+    _lastMicros = currentMicros;
+    uint8_t timerClock = _regs[SIM_EXTENSION] & SIM_EXTENSION_TD;
+    if (timerClock <= 1) // The 4096 Hz and 64 Hz timer clocks run freely
+    {
+        _timerPhase += elapsed * ((timerClock == 0) ? 4096 : 64);
+        timerTicks(_timerPhase / 1000000);
+        _timerPhase %= 1000000;
+    }
+    if (_regs[SIM_CONTROL] & 0x01)
+        return; // Held in reset
+    elapsed += _prescaler;
+    for (; elapsed >= 10000; elapsed -= 10000)
+        tick();
+    _prescaler = (uint32_t)elapsed;
+}
+
+void TwoWire::tick()
+{
+    uint8_t hundredths = fromBCD(_regs[SIM_HUNDREDTHS]) + 1;
+    _regs[SIM_HUNDREDTHS] = toBCD(hundredths % 100);
+    if (hundredths < 100)
+        return;
+
+    uint8_t second = fromBCD(_regs[SIM_SECONDS]) + 1;
+    _regs[SIM_SECONDS] = toBCD(second % 60);
+    if ((_regs[SIM_EXTENSION] & SIM_EXTENSION_USEL) == 0)
+        _regs[SIM_FLAG] |= SIM_FLAG_UF;
+    if ((_regs[SIM_EXTENSION] & SIM_EXTENSION_TD) == 2)
+        timerTicks(1);
+    if (second < 60)
+        return;
+
+    if (_regs[SIM_EXTENSION] & SIM_EXTENSION_USEL)
+        _regs[SIM_FLAG] |= SIM_FLAG_UF;
+    if ((_regs[SIM_EXTENSION] & SIM_EXTENSION_TD) == 3)
+        timerTicks(1);
+    uint8_t minute = fromBCD(_regs[SIM_MINUTES]) + 1;
+    _regs[SIM_MINUTES] = toBCD(minute % 60);
+    if (minute < 60)
+        return;
+
+    uint8_t hour = fromBCD(_regs[SIM_HOURS]) + 1;
+    _regs[SIM_HOURS] = toBCD(hour % 24);
+    if (hour < 24)
+        return;
+
+    _regs[SIM_WEEKDAYS] = (_regs[SIM_WEEKDAYS] & 0x40) ? 0x01 : (_regs[SIM_WEEKDAYS] << 1);
+    uint8_t year = fromBCD(_regs[SIM_YEARS]);
+    uint8_t month = fromBCD(_regs[SIM_MONTHS]);
+    uint8_t date = fromBCD(_regs[SIM_DATE]) + 1;
+    if (date <= daysInMonth(month, year))
+    {
+        _regs[SIM_DATE] = toBCD(date);
+        return;
+    }
+    _regs[SIM_DATE] = 0x01;
+    if (month < 12)
+    {
+        _regs[SIM_MONTHS] = toBCD(month + 1);
+        return;
+    }
+    _regs[SIM_MONTHS] = 0x01;
+    _regs[SIM_YEARS] = toBCD((year + 1) % 100);
+}
+
+// The count is kept here: TIMER_0 and TIMER_1 hold the preset, which is all a read returns
+void TwoWire::timerTicks(uint64_t count)
+{
+    uint16_t preset = ((_regs[SIM_TIMER_1] & 0x0F) << 8) | _regs[SIM_TIMER_0];
+    if (((_regs[SIM_EXTENSION] & SIM_EXTENSION_TE) == 0) || (preset == 0) || (count == 0))
+        return;
+    if (count < _timerCount)
+    {
+        _timerCount -= count;
+        return;
+    }
+    _regs[SIM_FLAG] |= SIM_FLAG_TF;
+    _timerCount = preset - ((count - _timerCount) % preset); // Reloaded from the preset each time it fires
+}
+
+void TwoWire::beginTransmission(uint8_t)
+{
+    catchUp();
+    _transmitting = true;
+    _haveAddress = false;
+    _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if (_transmitting == false)
+        return 0;
+    if (_haveAddress == false)
+    {
+        _pointer = value;
+        _haveAddress = true;
+    }
+    else if (_txLength < sizeof(_txBuffer))
+        _txBuffer[_txLength++] = value;
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+    _transmitting = false;
+    transactions++;
+    bytes += 1 + _haveAddress + _txLength;
+    currentMicros += SIM_MICROS_PER_BYTE * (1 + _haveAddress + _txLength);
+    if (failNext > 0)
+    {
+        failNext--;
+        return 2; // NACK on the address
+    }
+
+    for (uint8_t i = 0; i < _txLength; i++)
+    {
+        uint8_t reg = canonical(_pointer++);
+        uint8_t value = _txBuffer[i];
+        if (reg == SIM_FLAG)
+            value &= _regs[reg]; // Flags can only be cleared
+        if ((reg == SIM_SECONDS) || ((reg == SIM_CONTROL) && (value & 0x01)))
+        {
+            _regs[SIM_HUNDREDTHS] = 0;
+            _prescaler = 0;
+            _lastMicros = currentMicros;
+        }
+        if ((reg == SIM_EXTENSION) && (value & SIM_EXTENSION_TE) && ((_regs[reg] & SIM_EXTENSION_TE) == 0))
+        {
+            _timerCount = ((_regs[SIM_TIMER_1] & 0x0F) << 8) | _regs[SIM_TIMER_0]; // Started: count down from the preset
+            _timerPhase = 0;
+        }
+        if (reg != SIM_HUNDREDTHS) // Read only
+            _regs[reg] = value;
+    }
+    return 0; // Anything that was due while the bus was busy is caught up at the next transaction
+}
+
+uint8_t TwoWire::requestFrom(uint8_t, uint8_t quantity, bool)
+{
+    if (beforeRead != nullptr)
+        beforeRead(canonical(_pointer));
+    catchUp();
+    transactions++;
+    bytes += 1 + quantity;
+    if (quantity > sizeof(_rxBuffer))
+        quantity = sizeof(_rxBuffer);
+    _rxIndex = 0;
+    _rxLength = 0;
+    if (failNext > 0)
+    {
+        failNext--;
+        currentMicros += SIM_MICROS_PER_BYTE * (1 + quantity);
+        return 0;
+    }
+
+    currentMicros += SIM_MICROS_PER_BYTE; // The address
+    for (uint8_t i = 0; i < quantity; i++)
+    {
+        if (tickBetweenBytes)
+            catchUp();
+        _rxBuffer[_rxLength++] = _regs[canonical(_pointer++)];
+        currentMicros += SIM_MICROS_PER_BYTE;
+    }
+    return _rxLength;
+}
@@ -0,0 +1,110 @@
+/*
+  Replays bus traces from RV8803::exportTrace() against the simulated RV-8803 in mock/, to reproduce what the
+  library did on a unit in the field, and to compare what two versions of the library do for the same job.
+  Build it and run it with:
+    make -C test replay
+    test/replay before.bin [after.bin]
+
+  Save the trace as the raw bytes exportTrace() wrote, e.g. captured from a serial port. Each trace is replayed
+  at its recorded timing, with its recorded failures, on its own simulated RTC. A register is loaded with the
+  value it was first read with, unless the trace wrote it first. After that every read is checked against the
+  simulator:
+  - A configuration register that reads differently means the trace is incomplete (records were dropped) or the
+    part did something the simulator doesn't.
+  - The time and flag registers may be a hundredth or so out, so those mismatches are only counted.
+  With two traces the bus traffic is compared, and so are the registers both left behind.
+
+  The exit code is non-zero if a trace can't be read or a configuration register mismatched.
+*/
+
+#include "trace.h"
+#include "SparkFun_RV8803.h"
+
+static bool loadTrace(const char* path, std::vector<TraceRecord> &records)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        printf("%s: can't open\n", path);
+        return false;
+    }
+    std::vector<uint8_t> trace;
+    uint8_t buffer[512];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        trace.insert(trace.end(), buffer, buffer + got);
+    fclose(file);
+
+    const char* error = nullptr;
+    if (parseTrace(trace.data(), trace.size(), records, error) == false)
+    {
+        printf("%s: %s\n", path, error);
+        return false;
+    }
+    return true;
+}
+
+static void printReport(const char* path, const std::vector<TraceRecord> &records, const ReplayReport &report)
+{
+    printf("%s:\n", path);
+    printf("  %lu records over %.3f s: %lu reads, %lu writes, %lu failed\n", (unsigned long)report.records,
+           report.spanMicros / 1e6, (unsigned long)report.reads, (unsigned long)report.writes, (unsigned long)report.failed);
+    // Each byte is 9 clocks (8 data and the ACK), plus a start and a stop per transaction
+    uint32_t clocks = (report.bytes * 9) + (report.transactions * 2);
+    printf("  %lu transactions, %lu bytes: %.1f ms of bus time at 100 kHz, %.1f ms at 400 kHz\n",
+           (unsigned long)report.transactions, (unsigned long)report.bytes, clocks / 100.0, clocks / 400.0);
+    printf("  %lu configuration register bytes differ from the simulator, %lu time and flag bytes\n",
+           (unsigned long)report.registerMismatches, (unsigned long)report.timeMismatches);
+    if (report.firstMismatch >= 0)
+    {
+        const TraceRecord &record = records[report.firstMismatch];
+        printf("  first at record %ld: read of %u bytes from 0x%02X at %lu us\n", (long)report.firstMismatch, record.len,
+               record.addr, (unsigned long)record.micros);
+    }
+}
+
+static void printDifference(const char* name, uint32_t before, uint32_t after)
+{
+    printf("  %-14s %8lu -> %8lu (%+ld)\n", name, (unsigned long)before, (unsigned long)after, (long)after - (long)before);
+}
+
+int main(int argc, char** argv)
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        printf("usage: %s trace.bin [other.bin]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<TraceRecord> records[2];
+    ReplayReport reports[2];
+    bool ok = true;
+    for (int trace = 0; trace < argc - 1; trace++)
+    {
+        if (loadTrace(argv[trace + 1], records[trace]) == false)
+            return 1;
+        TwoWire sim;
+        replayTrace(records[trace], sim, reports[trace]);
+        printReport(argv[trace + 1], records[trace], reports[trace]);
+        ok = ok && (reports[trace].registerMismatches == 0);
+    }
+
+    if (argc == 3)
+    {
+        printf("Difference:\n");
+        printDifference("records", reports[0].records, reports[1].records);
+        printDifference("reads", reports[0].reads, reports[1].reads);
+        printDifference("writes", reports[0].writes, reports[1].writes);
+        printDifference("failed", reports[0].failed, reports[1].failed);
+        printDifference("transactions", reports[0].transactions, reports[1].transactions);
+        printDifference("bytes", reports[0].bytes, reports[1].bytes);
+        for (uint8_t reg = 0x07; reg < sizeof(reports[0].registers); reg++)
+        {
+            if (((reg > RV8803_RAM) && (reg < RV8803_MINUTES_ALARM)) || (reg == RV8803_FLAG))
+                continue; // Mirrors, the time and the flags, which are time driven
+            if (reports[0].known[reg] && reports[1].known[reg] && (reports[0].registers[reg] != reports[1].registers[reg]))
+                printf("  register 0x%02X left at 0x%02X -> 0x%02X\n", reg, reports[0].registers[reg], reports[1].registers[reg]);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,1819 @@
+/*
+  Host soak test for the RV-8803 library, against the simulated RTC in mock/. Build and run it with:
+    make -C test
+
+  1. setEpoch() -> updateTime() -> getEpoch() round trip for every day from 2000 to 2099, in every time zone from
+     -12:00 to +14:00 in quarter hours, with both use1970sEpoch settings, checked against the C library's gmtime_r()
+     and timegm(), and the string functions against strftime()
+  2. updateTime() polled across every kind of rollover (second to year, leap days, 2099 to 2000), with injected bus
+     errors: every snapshot must be a time the RTC really held while it was being read
+  3. The same with the simulated clock running through the bytes of each burst, with the carry swept across every
+     byte: snapshots must still be coherent, and the re-reads must be counted. setTimePrecise()'s skew across the
+     99 -> 00 wrap of the hundredths
+  4. onSecond() and onMinute() driven by polling updateTime() and serviceTimeUpdates() or serviceInterrupts(), with
+     and without time sets: every minute callback must come at second 00, without the bus lock held
+  5. Random sequences of setters, reads and delays, checking the snapshots and the monotonic clock after each one
+  6. parseTime8601() on edge cases, every truncation of a full string and random damage to valid ones, and how fast
+     it parses
+  7. The NMEA parser on RMC and ZDA sentences with good and bad fields, checksums and framing, and
+     setTimeFromNMEA() with and without a simulated PPS pulse
+  8. RV8803_Snapshot arithmetic on random pairs of times, near and far apart, against gmtime_r(): hundredthsSince()
+     and its saturation, compare(), addHundredths() to the ends of the century, and the BCD round trip
+  9. getNextAlarmEpoch() without a good snapshot, and for alarms past midnight, month end and year end, against
+     timegm()
+  10. The countdown timer at each timer clock: every read returns the preset, and the predicted time left and expiry
+      epoch match when the simulated timer fires, over several periods
+  11. Slewing from several calibration baselines: OFFSET held at its limit for the predicted time, the correction
+      that makes, the correction left as it goes, and the baseline restored at the end, by stopSlew() and after a
+      failed restore
+  12. The configuration blob: every single bit error caught by the CRC, readConfig() -> writeConfig() round trip
+      through a power-on reset, only the differing registers written and in as few bursts as possible, diffConfig(),
+      FLAG, RESET and TEST never written, and a timer preset changed while it runs
+  13. begin(profile) after a power-on reset, with the RTC already matching and with single registers changed: the
+      path it reports, the bus traffic against a bare probe and readConfig(), FLAG left alone and the time validity
+  14. (C++17) RV8803_Clock::now() against the simulated clock in another time zone, the time zone read under the
+      same lock, no bus traffic within the staleness budget, and the RV8803's own snapshot left alone
+  15. The bus trace recorder: a run with injected failures replayed on a second simulated RTC with trace.cpp
+      must make the same bus traffic and leave the same configuration, failed reads are recorded without data,
+      and rings of every size keep the newest records whole and count the ones they drop
+  16. Four threads with their own RV8803 sharing the bus through a std::recursive_mutex: no torn snapshots, no lost
+      read-modify-write updates, and how long each waited for the lock
+  17. Bus traffic and host time per call for the common operations
+
+  Any failure is printed and the exit code is non-zero. Set SOAK_SEED to repeat a run of part 5.
+*/
+
+#include "SparkFun_RV8803.h"
+#include "trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <time.h>
+
+#define SECONDS_FROM_1970_TO_2000	946684800LL
+#define DAYS_2000_TO_2099			36525L
+#define TZ_MIN_QUARTER_HOURS		-48 // UTC-12:00
+#define TZ_MAX_QUARTER_HOURS		56 // UTC+14:00
+#define MAX_REPORTED_FAILURES		20
+
+static RV8803 rtc;
+static std::atomic<uint32_t> checks(0); // The contention test checks from several threads
+static std::atomic<uint32_t> failures(0);
+
+#define CHECK(condition, ...) \
+    do { \
+        checks++; \
+        if (!(condition)) \
+        { \
+            if (failures++ < MAX_REPORTED_FAILURES) \
+            { \
+                printf("  FAIL line %d: ", __LINE__); \
+                printf(__VA_ARGS__); \
+                printf("\n"); \
+            } \
+        } \
+    } while (0)
+
+static uint32_t randomState = 1;
+
+static uint32_t randomNumber(uint32_t limit) // 0 to limit - 1
+{
+    randomState ^= randomState << 13; // xorshift32
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState % limit;
+}
+
+// Days since 2000-01-01, counted the slow way so it shares nothing with the library or the simulator
+static int32_t daysSince2000(uint16_t year, uint8_t month, uint8_t date)
+{
+    static const uint8_t monthDays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int32_t days = 0;
+    for (uint16_t y = 2000; y < year; y++)
+        days += ((y % 4) == 0) ? 366 : 365;
+    for (uint8_t m = 1; m < month; m++)
+        days += monthDays[m - 1] + (((m == 2) && ((year % 4) == 0)) ? 1 : 0);
+    return days + date - 1;
+}
+
+// The library's last snapshot as hundredths since 2000-01-01, from the individual getters
+static int64_t snapshotHundredths(RV8803 &clock = rtc)
+{
+    int64_t days = daysSince2000(clock.getYear(), clock.getMonth(), clock.getDate());
+    int64_t seconds = (days * 86400) + (clock.getHours() * 3600) + (clock.getMinutes() * 60) + clock.getSeconds();
+    return (seconds * 100) + clock.getHundredths();
+}
+
+static uint8_t weekdayOf(int64_t hundredths)
+{
+    return ((hundredths / 8640000) + 6) % 7; // 2000-01-01 was a Saturday
+}
+
+// Checks the snapshot is a time the RTC held between the two readings of the simulator (hundredths since 2000).
+// The RTC wraps from 2099 to 2000, so compare modulo a century
+// Returns false if it isn't
+static bool checkSnapshot(int64_t before, int64_t after, const char* context, bool checkWeekday = true, RV8803 &clock = rtc)
+{
+    const int64_t century = DAYS_2000_TO_2099 * 8640000LL;
+    int64_t snapshot = snapshotHundredths(clock);
+    int64_t sinceBefore = ((snapshot - before) % century + century) % century;
+    int64_t span = ((after - before) % century + century) % century;
+    bool coherent = (sinceBefore <= span) && (!checkWeekday || (clock.getWeekday() == weekdayOf(snapshot)));
+    CHECK(sinceBefore <= span, "%s: snapshot %lld is not between %lld and %lld", context, (long long)snapshot, (long long)before, (long long)after);
+    if (checkWeekday)
+        CHECK(clock.getWeekday() == weekdayOf(snapshot), "%s: weekday %d, expected %d", context, clock.getWeekday(), weekdayOf(snapshot));
+    return coherent;
+}
+
+// The string functions against strftime() in the C locale, which has the same English names
+static void checkStrings(const struct tm &expected)
+{
+    static const struct { const char* format; char* (RV8803::*function)(char*, size_t); } strings[] = {
+        { "%Y-%m-%dT%H:%M:%S", &RV8803::stringTime8601 },
+        { "%d/%m/%Y", &RV8803::stringDate },
+        { "%m/%d/%Y", &RV8803::stringDateUSA },
+        { "%H:%M:%S", &RV8803::stringTime },
+        { "%A", &RV8803::stringDayOfWeek },
+        { "%a", &RV8803::stringDayOfWeekShort },
+        { "%B", &RV8803::stringMonth },
+        { "%b", &RV8803::stringMonthShort },
+    };
+    for (const auto &string : strings)
+    {
+        char want[32];
+        char got[32];
+        strftime(want, sizeof(want), string.format, &expected);
+        (rtc.*string.function)(got, sizeof(got));
+        CHECK(strcmp(got, want) == 0, "%s gave \"%s\", strftime() \"%s\"", string.format, got, want);
+        (rtc.*string.function)(got, 4); // Cut short
+        want[3] = '\0';
+        CHECK(strcmp(got, want) == 0, "%s into 4 bytes gave \"%s\", expected \"%s\"", string.format, got, want);
+    }
+}
+
+static void testEpochRoundTrip()
+{
+    printf("Epoch round trip: %ld days x %d time zones x 2 epochs, against gmtime_r() and timegm()\n", DAYS_2000_TO_2099,
+           TZ_MAX_QUARTER_HOURS - TZ_MIN_QUARTER_HOURS + 1);
+    time_t zero = 0;
+    struct tm check;
+    bool timeT1970 = (gmtime_r(&zero, &check)->tm_year == 70);
+
+    for (uint8_t use1970sEpoch = 0; use1970sEpoch < 2; use1970sEpoch++)
+    {
+        int64_t valueOffset = (use1970sEpoch || timeT1970) ? SECONDS_FROM_1970_TO_2000 : 0; // Where value counts from, relative to 2000
+        for (int8_t tz = TZ_MIN_QUARTER_HOURS; tz <= TZ_MAX_QUARTER_HOURS; tz++)
+        {
+            CHECK(rtc.setTimeZoneQuarterHours(tz), "setTimeZoneQuarterHours(%d)", tz);
+            for (int32_t day = 0; day < DAYS_2000_TO_2099; day++)
+            {
+                int64_t local = ((int64_t)day * 86400) + ((day * 7919L + (tz + 48) * 601L) % 86400); // Every time of day turns up
+                int64_t utc = local - (tz * 900L);
+                uint32_t value = utc + valueOffset;
+
+                bool set = (day & 1) ? rtc.setEpoch(value, use1970sEpoch, tz) : rtc.setEpoch(value, use1970sEpoch); // tz = 0 uses RAM
+                CHECK(set, "setEpoch(%u, %d, %d) failed with %d", value, use1970sEpoch, tz, rtc.getLastError());
+
+                // What libc makes of the local time
+                time_t localT = local + SECONDS_FROM_1970_TO_2000;
+                struct tm expected;
+                gmtime_r(&localT, &expected);
+                CHECK(rtc.updateTime(), "updateTime failed");
+                CHECK((rtc.getYear() == expected.tm_year + 1900) && (rtc.getMonth() == expected.tm_mon + 1) && (rtc.getDate() == expected.tm_mday) &&
+                      (rtc.getHours() == expected.tm_hour) && (rtc.getMinutes() == expected.tm_min) && (rtc.getSeconds() == expected.tm_sec) &&
+                      (rtc.getWeekday() == expected.tm_wday),
+                      "setEpoch(%u, %d, %d) wrote %s weekday %d, gmtime_r() says %04d-%02d-%02dT%02d:%02d:%02d weekday %d", value,
+                      use1970sEpoch, tz, rtc.stringTime8601(), rtc.getWeekday(), expected.tm_year + 1900, expected.tm_mon + 1,
+                      expected.tm_mday, expected.tm_hour, expected.tm_min, expected.tm_sec, expected.tm_wday);
+
+                // And back, from the registers
+                check = {};
+                check.tm_year = rtc.getYear() - 1900;
+                check.tm_mon = rtc.getMonth() - 1;
+                check.tm_mday = rtc.getDate();
+                check.tm_hour = rtc.getHours();
+                check.tm_min = rtc.getMinutes();
+                check.tm_sec = rtc.getSeconds();
+                int64_t localEpoch = (int64_t)timegm(&check) - SECONDS_FROM_1970_TO_2000 + valueOffset;
+                CHECK(rtc.getLocalEpoch(use1970sEpoch) == localEpoch, "getLocalEpoch(%d) %u, timegm() says %lld",
+                      use1970sEpoch, rtc.getLocalEpoch(use1970sEpoch), (long long)localEpoch);
+                CHECK(rtc.getEpoch(use1970sEpoch) == localEpoch - (tz * 900L), "getEpoch(%d) %u, timegm() says %lld",
+                      use1970sEpoch, rtc.getEpoch(use1970sEpoch), (long long)(localEpoch - (tz * 900L)));
+                CHECK(rtc.getEpoch(use1970sEpoch) == value, "getEpoch(%d) %u after setEpoch(%u)", use1970sEpoch, rtc.getEpoch(use1970sEpoch), value);
+
+                if (tz == 0) // Once a day is enough for the strings, which don't depend on the zone
+                    checkStrings(expected);
+            }
+
+            // Local times either side of the range the RTC can hold are refused, and the clock is left alone
+            int64_t before = Wire.getClockHundredths();
+            CHECK(!rtc.setEpoch(-1 - (tz * 900L) + valueOffset, use1970sEpoch, tz), "setEpoch accepted 1999 in tz %d", tz);
+            CHECK(rtc.getLastError() == RV8803_ERROR_INVALID_ARGUMENT, "1999 in tz %d: error %d", tz, rtc.getLastError());
+            CHECK(!rtc.setEpoch((DAYS_2000_TO_2099 * 86400LL) - (tz * 900L) + valueOffset, use1970sEpoch, tz), "setEpoch accepted 2100 in tz %d", tz);
+            CHECK(Wire.getClockHundredths() - before < 100, "refused setEpoch moved the clock");
+        }
+    }
+    rtc.setTimeZoneQuarterHours(0);
+}
+
+struct Boundary { uint16_t year; uint8_t month, date, hour, minute, second; };
+static const Boundary boundaries[] = {
+    { 2024, 6, 15, 12, 34, 59 }, // Second
+    { 2024, 6, 15, 12, 59, 59 }, // Hour
+    { 2024, 6, 15, 23, 59, 59 }, // Day
+    { 2024, 4, 30, 23, 59, 59 }, // 30 day month
+    { 2023, 2, 28, 23, 59, 59 }, // Not a leap year
+    { 2024, 2, 28, 23, 59, 59 }, // Into a leap day
+    { 2024, 2, 29, 23, 59, 59 }, // Out of one
+    { 2000, 2, 29, 23, 59, 59 }, // 2000 was a leap year
+    { 2024, 12, 31, 23, 59, 59 }, // Year
+    { 2099, 12, 31, 23, 59, 59 }, // Century: back to 2000
+};
+
+static void testRollovers()
+{
+    const uint16_t polls = 2000;
+    printf("Rollovers: %u boundaries x %u polls, with bus errors\n", (unsigned)(sizeof(boundaries) / sizeof(boundaries[0])), polls);
+
+    rtc.setRetryPolicy(RV8803_DEFAULT_RETRIES, RV8803_DEFAULT_BACKOFF_US, RV8803_DEFAULT_DEADLINE_US);
+    for (const Boundary &b : boundaries)
+    {
+        Wire.setClock(b.year, b.month, b.date, b.hour, b.minute, b.second, 80);
+        for (uint16_t poll = 0; poll < polls; poll++)
+        {
+            simAdvanceMicros(randomNumber(400)); // Polls closer together than the 10ms tick, so every hundredth is seen
+            if (randomNumber(50) == 0)
+                Wire.failNext = 1 + randomNumber(RV8803_DEFAULT_RETRIES); // Recovered by the retries
+            int64_t before = Wire.getClockHundredths();
+            bool read = rtc.updateTime();
+            int64_t after = Wire.getClockHundredths();
+            CHECK(read, "updateTime failed at %04u-%02u-%02u poll %u", b.year, b.month, b.date, poll);
+            if (read)
+                checkSnapshot(before, after, "rollover", b.year != 2099); // Like the real part, the weekday carries on into 2000
+        }
+    }
+}
+
+// The simulator's local time as a setEpoch() value counting from 1970
+static uint32_t simLocalEpoch()
+{
+    return (Wire.getClockHundredths() / 100) + SECONDS_FROM_1970_TO_2000;
+}
+
+static void randomTime(uint8_t* time)
+{
+    time[TIME_HUNDREDTHS] = 0;
+    time[TIME_SECONDS] = RV8803::DECtoBCD(randomNumber(60));
+    time[TIME_MINUTES] = RV8803::DECtoBCD(randomNumber(60));
+    time[TIME_HOURS] = RV8803::DECtoBCD(randomNumber(24));
+    time[TIME_DATE] = RV8803::DECtoBCD(1 + randomNumber(28)); // Valid in every month, whatever else is written
+    time[TIME_MONTH] = RV8803::DECtoBCD(1 + randomNumber(12));
+    time[TIME_YEAR] = RV8803::DECtoBCD(randomNumber(100));
+    time[TIME_WEEKDAY] = 1 << ((daysSince2000(2000 + RV8803::BCDtoDEC(time[TIME_YEAR]), RV8803::BCDtoDEC(time[TIME_MONTH]),
+                                              RV8803::BCDtoDEC(time[TIME_DATE])) + 6) % 7);
+}
+
+static uint64_t skewReadAt = 0; // When the armed read happens, in simMicros(). 0 = not armed
+static uint8_t skewReadHundredths = 0xFF; // What it reads, or 0xFF for whatever the clock says
+
+static void delaySkewRead(uint8_t reg)
+{
+    if ((skewReadAt == 0) || (reg != RV8803_HUNDREDTHS))
+        return;
+    simAdvanceMicros(skewReadAt - simMicros());
+    if (skewReadHundredths != 0xFF)
+    {
+        Wire.getClockHundredths(); // Catch up, then move the clock on
+        Wire.pokeRegister(RV8803_HUNDREDTHS, skewReadHundredths);
+    }
+    skewReadAt = 0;
+}
+
+// Calls setTimePrecise() with its read back of the hundredths put off until readAfterMicros past the target instant,
+// optionally with the clock moved to hundredths just before
+static int8_t measureSkew(uint32_t readAfterMicros, uint8_t hundredths)
+{
+    uint8_t time[TIME_ARRAY_LENGTH];
+    randomTime(time);
+    uint64_t now = simMicros();
+    uint32_t fireAt = (uint32_t)now + 5000;
+    skewReadAt = now + 5000 + readAfterMicros;
+    skewReadHundredths = hundredths;
+    Wire.beforeRead = delaySkewRead;
+    int8_t skew = 99;
+    CHECK(rtc.setTimePrecise(time, fireAt, &skew), "setTimePrecise failed");
+    Wire.beforeRead = nullptr;
+    return skew;
+}
+
+// Lets the simulated clock run while bursts are read, unlike the real part, and sweeps the tick across every byte of
+// updateTime()'s burst at every kind of rollover. Every snapshot must still be coherent, and the ones that straddled
+// the tick must show up in getSnapshotRetryCount()
+static void testTornReads()
+{
+    const uint32_t stepMicros = 5;
+    printf("Torn reads: %u boundaries, tick swept across the burst in %lu us steps, with and without the flags\n",
+           (unsigned)(sizeof(boundaries) / sizeof(boundaries[0])), (unsigned long)stepMicros);
+    rtc.setRetryPolicy(RV8803_DEFAULT_RETRIES, RV8803_DEFAULT_BACKOFF_US, RV8803_DEFAULT_DEADLINE_US);
+    Wire.tickBetweenBytes = true;
+    for (uint8_t tracking = 0; tracking < 2; tracking++)
+    {
+        rtc.enableTimeValidityTracking(tracking);
+        uint32_t reads = 0;
+        uint32_t retries = 0;
+        for (const Boundary &b : boundaries)
+        {
+            uint32_t boundaryRetries = rtc.getSnapshotRetryCount();
+            for (uint32_t lead = 0; lead <= 600; lead += stepMicros) // A burst with the flags takes about 450 us
+            {
+                Wire.setClock(b.year, b.month, b.date, b.hour, b.minute, b.second, 99);
+                simAdvanceMicros(10000 - lead); // The carry comes lead us after this
+                uint32_t before = rtc.getSnapshotRetryCount();
+                int64_t start = Wire.getClockHundredths();
+                CHECK(rtc.updateTime(), "updateTime failed");
+                checkSnapshot(start, Wire.getClockHundredths(), "torn read", b.year != 2099);
+                CHECK(rtc.getSnapshotRetryCount() - before <= 1, "%lu retries for one read", (unsigned long)(rtc.getSnapshotRetryCount() - before));
+                reads++;
+            }
+            boundaryRetries = rtc.getSnapshotRetryCount() - boundaryRetries;
+            retries += boundaryRetries;
+            CHECK(boundaryRetries > 0, "no read of %04u-%02u-%02u %02u:%02u:%02u needed a retry", b.year, b.month, b.date, b.hour, b.minute, b.second);
+        }
+        printf("  %-16s %lu reads, %lu re-read after a rollover\n", tracking ? "with flags:" : "without flags:", (unsigned long)reads, (unsigned long)retries);
+    }
+    rtc.enableTimeValidityTracking(false);
+    Wire.tickBetweenBytes = false;
+
+    // setTimePrecise()'s skew, where the hundredths read back have wrapped and the ones expected haven't, or the
+    // other way around
+    int8_t skew = measureSkew(999960, 0xFF); // Reads 99 when 00 is due
+    CHECK((skew == -1) || (skew == 0), "99 read when 00 was due gave a skew of %d", skew);
+    skew = measureSkew(989960, 0x01); // Reads 01 when 99 is due
+    CHECK(skew == 2, "01 read when 99 was due gave a skew of %d", skew);
+    skew = measureSkew(495000, 0xFF); // Nowhere near the wrap
+    CHECK((skew == -1) || (skew == 0), "skew of %d with nothing to wrap", skew);
+}
+
+static uint32_t secondCalls = 0;
+static uint32_t minuteCalls = 0;
+static int lockDepth = 0;
+static uint32_t outerLocks = 0; // Times the lock was taken when it wasn't held
+
+static void countingLock(void*)
+{
+    if (lockDepth++ == 0)
+        outerLocks++;
+}
+
+static void countingUnlock(void*)
+{
+    lockDepth--;
+}
+
+static void countSecond()
+{
+    secondCalls++;
+    CHECK(lockDepth == 0, "onSecond called with the bus lock held");
+}
+
+static void checkMinute()
+{
+    minuteCalls++;
+    CHECK(Wire.peekRegister(RV8803_SECONDS) == 0x00, "onMinute called at second %02X", Wire.peekRegister(RV8803_SECONDS));
+    CHECK(lockDepth == 0, "onMinute called with the bus lock held");
+}
+
+// Polls updateTime() then serviceTimeUpdates() or serviceInterrupts() at random intervals shorter than a second, so
+// every tick is seen, and sometimes with a tick already pending when the snapshot is taken. Every minute callback
+// must come at second 00
+static void pollTimeUpdates(uint32_t polls)
+{
+    for (uint32_t poll = 0; poll < polls; poll++)
+    {
+        simAdvanceMicros(randomNumber(300000));
+        CHECK(rtc.updateTime(), "updateTime failed");
+        if (randomNumber(2))
+            rtc.serviceTimeUpdates();
+        else
+            rtc.serviceInterrupts();
+    }
+}
+
+static void testTimeUpdates()
+{
+    const uint32_t minutes = 60;
+    const uint32_t sets = 200;
+    printf("Time updates: %lu minutes polled, then %lu time sets\n", (unsigned long)minutes, (unsigned long)sets);
+    Wire.setClock(2024, 6, 15, 12, 0, 30, 0);
+    Wire.pokeRegister(RV8803_FLAG, 0);
+    rtc.onSecond(countSecond);
+    rtc.onMinute(checkMinute);
+    rtc.setLockCallbacks(countingLock, countingUnlock, nullptr);
+
+    // Left alone, every second and every minute is reported once
+    secondCalls = 0;
+    minuteCalls = 0;
+    int64_t start = Wire.getClockHundredths();
+    while (Wire.getClockHundredths() - start < (int64_t)minutes * 6000)
+        pollTimeUpdates(1);
+    int64_t elapsedSeconds = (Wire.getClockHundredths() / 100) - (start / 100);
+    CHECK((secondCalls >= elapsedSeconds - 1) && (secondCalls <= elapsedSeconds), "%lu second callbacks in %lld seconds",
+          (unsigned long)secondCalls, (long long)elapsedSeconds);
+    CHECK(minuteCalls == minutes, "%lu minute callbacks in %lu minutes", (unsigned long)minuteCalls, (unsigned long)minutes);
+
+    // Setting the time mustn't leave the count out of step
+    uint8_t time[TIME_ARRAY_LENGTH];
+    for (uint32_t set = 0; set < sets; set++)
+    {
+        randomTime(time);
+        if (randomNumber(2))
+            CHECK(rtc.setTime(time, TIME_ARRAY_LENGTH), "setTime failed");
+        else
+            CHECK(rtc.setTimeFields(TIME_FIELD_SECONDS, time), "setTimeFields failed");
+        pollTimeUpdates(1 + randomNumber(1000));
+    }
+
+    rtc.onSecond(nullptr);
+    rtc.onMinute(nullptr);
+    rtc.setLockCallbacks(nullptr, nullptr, nullptr);
+    CHECK(lockDepth == 0, "bus lock left held %d deep", lockDepth);
+}
+
+static void testRandomSequences(uint32_t seed)
+{
+    const uint32_t steps = 200000;
+    printf("Random sequences: %lu steps, seed %lu\n", (unsigned long)steps, (unsigned long)seed);
+    randomState = seed;
+    Wire.setClock(2024, 1, 1, 0, 0, 0, 0);
+    rtc.setTimeZoneQuarterHours(0);
+    rtc.updateTime();
+    uint64_t lastMonotonic = rtc.getMonotonicMillis();
+    uint64_t lastMicros = simMicros();
+
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        uint8_t time[TIME_ARRAY_LENGTH];
+        uint32_t op = randomNumber(100);
+        if (op < 30)
+            simAdvanceMicros(randomNumber(2000000)); // Up to 2 seconds
+        else if (op < 32)
+            simAdvanceMicros(60000000ULL * (1 + randomNumber(10))); // Minutes between polls
+        else if (op < 60)
+        {
+            int64_t before = Wire.getClockHundredths();
+            CHECK(rtc.updateTime(), "step %lu: updateTime failed", (unsigned long)step);
+            checkSnapshot(before, Wire.getClockHundredths(), "updateTime");
+        }
+        else if (op < 66)
+        {
+            int8_t tz = TZ_MIN_QUARTER_HOURS + randomNumber(TZ_MAX_QUARTER_HOURS - TZ_MIN_QUARTER_HOURS + 1);
+            uint32_t local = SECONDS_FROM_1970_TO_2000 + randomNumber(DAYS_2000_TO_2099 - 2) * 86400UL + 86400 + randomNumber(86400);
+            if (tz == 0)
+                rtc.setTimeZoneQuarterHours(0); // Otherwise setEpoch() uses the zone already in RAM
+            CHECK(rtc.setEpoch(local - (tz * 900L), true, tz), "step %lu: setEpoch failed", (unsigned long)step);
+            CHECK(simLocalEpoch() == local, "step %lu: setEpoch wrote %u, expected %u", (unsigned long)step, simLocalEpoch(), local);
+        }
+        else if (op < 76)
+        {
+            uint8_t mask = randomNumber(256) & TIME_FIELD_ALL;
+            if (mask & (TIME_FIELD_MONTH | TIME_FIELD_YEAR))
+                mask |= TIME_FIELD_DATE; // So the date stays valid in the new month
+            randomTime(time);
+            Wire.getClockHundredths();
+            Wire.pokeRegister(RV8803_HUNDREDTHS, 0); // A second clear of any carry into the fields being written
+            CHECK(rtc.setTimeFields(mask, time), "step %lu: setTimeFields(0x%02X) failed", (unsigned long)step, mask);
+            for (uint8_t field = TIME_SECONDS; field < TIME_ARRAY_LENGTH; field++)
+                if (mask & (1 << field))
+                    CHECK(Wire.peekRegister(RV8803_HUNDREDTHS + field) == time[field], "step %lu: field %u is %02X, wrote %02X",
+                          (unsigned long)step, field, Wire.peekRegister(RV8803_HUNDREDTHS + field), time[field]);
+            time[TIME_WEEKDAY] = 1 << weekdayOf(Wire.getClockHundredths()); // Back in step with the date for checkSnapshot()
+            rtc.setTimeFields(TIME_FIELD_WEEKDAY, time);
+        }
+        else if (op < 82)
+        {
+            randomTime(time);
+            CHECK(rtc.setTime(time, TIME_ARRAY_LENGTH), "step %lu: setTime failed", (unsigned long)step);
+        }
+        else if (op < 86)
+        {
+            char iso8601[RV8803_TIME8601TZ_STRING_LENGTH];
+            randomTime(time);
+            snprintf(iso8601, sizeof(iso8601), "20%02X-%02X-%02XT%02X:%02X:%02X", time[TIME_YEAR], time[TIME_MONTH], time[TIME_DATE],
+                     time[TIME_HOURS], time[TIME_MINUTES], time[TIME_SECONDS]);
+            CHECK(rtc.setTime8601(iso8601), "step %lu: setTime8601(%s) failed", (unsigned long)step, iso8601);
+        }
+        else if (op < 90)
+        {
+            randomTime(time);
+            CHECK(rtc.setTimePrecise(time, micros() + randomNumber(20000)), "step %lu: setTimePrecise failed", (unsigned long)step);
+        }
+        else if (op < 93)
+            CHECK(rtc.setHundredthsToZero(), "step %lu: setHundredthsToZero failed", (unsigned long)step);
+        else if (op < 96)
+            CHECK(rtc.setTimeZoneQuarterHours(TZ_MIN_QUARTER_HOURS + randomNumber(TZ_MAX_QUARTER_HOURS - TZ_MIN_QUARTER_HOURS + 1)),
+                  "step %lu: setTimeZoneQuarterHours failed", (unsigned long)step);
+        else
+            Wire.failNext = 1 + randomNumber(RV8803_DEFAULT_RETRIES); // The next operation has to retry
+
+        // Whatever the time was set to, the monotonic clock never goes backwards or runs ahead of real time
+        uint64_t monotonic = rtc.getMonotonicMillis();
+        uint64_t elapsedMillis = (simMicros() - lastMicros) / 1000;
+        CHECK(monotonic >= lastMonotonic, "step %lu: monotonic clock went back %llu ms", (unsigned long)step,
+              (unsigned long long)(lastMonotonic - monotonic));
+        CHECK(monotonic <= lastMonotonic + elapsedMillis + 20, "step %lu (op %lu): monotonic clock jumped %llu ms in %llu ms",
+              (unsigned long)step, (unsigned long)op, (unsigned long long)(monotonic - lastMonotonic), (unsigned long long)elapsedMillis);
+        lastMonotonic = monotonic;
+        lastMicros = simMicros();
+    }
+    Wire.failNext = 0;
+}
+
+// Parses text and, if it is accepted, checks the result is a real time (weekday from timegm()) in a real time zone,
+// and that printing it and parsing it again gives the same thing
+static bool checkParse8601(const char* text, uint8_t* time, int8_t &quarterHours)
+{
+    bool hasTimeZone;
+    if (RV8803::parseTime8601(text, time, quarterHours, hasTimeZone) == false)
+        return false;
+
+    CHECK(RV8803::isValidTime(time), "\"%s\" parsed to an invalid time", text);
+    CHECK((quarterHours >= -56) && (quarterHours <= 56), "\"%s\" parsed to time zone %d", text, quarterHours);
+    CHECK(hasTimeZone || (quarterHours == 0), "\"%s\" has no time zone but parsed to %d", text, quarterHours);
+    struct tm tm = {};
+    tm.tm_year = 100 + RV8803::BCDtoDEC(time[TIME_YEAR]);
+    tm.tm_mon = RV8803::BCDtoDEC(time[TIME_MONTH]) - 1;
+    tm.tm_mday = RV8803::BCDtoDEC(time[TIME_DATE]);
+    time_t t = timegm(&tm);
+    gmtime_r(&t, &tm);
+    CHECK(time[TIME_WEEKDAY] == (1 << tm.tm_wday), "\"%s\" parsed to weekday %02X, timegm() says %d", text, time[TIME_WEEKDAY], tm.tm_wday);
+
+    char again[40];
+    uint8_t zone = (quarterHours < 0) ? -quarterHours : quarterHours;
+    snprintf(again, sizeof(again), "20%02X-%02X-%02XT%02X:%02X:%02X.%02X%c%02d:%02d", time[TIME_YEAR], time[TIME_MONTH], time[TIME_DATE],
+             time[TIME_HOURS], time[TIME_MINUTES], time[TIME_SECONDS], time[TIME_HUNDREDTHS], (quarterHours < 0) ? '-' : '+', zone / 4, (zone % 4) * 15);
+    uint8_t timeAgain[TIME_ARRAY_LENGTH];
+    int8_t quarterHoursAgain;
+    CHECK(RV8803::parseTime8601(again, timeAgain, quarterHoursAgain, hasTimeZone) && (memcmp(time, timeAgain, TIME_ARRAY_LENGTH) == 0) &&
+          (quarterHours == quarterHoursAgain), "\"%s\" parsed differently printed as \"%s\"", text, again);
+    return true;
+}
+
+static void testParse8601()
+{
+    const uint32_t fuzzRuns = 1000000;
+    printf("ISO 8601 parser: edge cases, every truncation, %lu mutated strings, throughput\n", (unsigned long)fuzzRuns);
+    uint8_t time[TIME_ARRAY_LENGTH];
+    int8_t quarterHours;
+
+    static const struct { const char* text; bool accepted; int8_t quarterHours; } cases[] = {
+        { "2024-06-15T12:34:56", true, 0 },
+        { "2024-06-15 12:34:56Z", true, 0 },
+        { "2024-06-15t12:34:56.5z", true, 0 },
+        { "2024-06-15T12:34:56,25+05:30", true, 22 },
+        { "2024-06-15T12:34:56+0545", true, 23 },
+        { "2024-06-15T12:34:56-03", true, -12 },
+        { "2024-06-15T12:34:56+14:00", true, 56 }, // Kiribati
+        { "2024-06-15T12:34:56-14:00", true, -56 },
+        { "2024-06-15T12:34:56-12:00", true, -48 },
+        { "2024-06-15T12:34:56+14:15", false, 0 },
+        { "2024-06-15T12:34:56-14:15", false, 0 },
+        { "2024-06-15T12:34:56+15:00", false, 0 },
+        { "2024-06-15T12:34:56+31:00", false, 0 },
+        { "2024-06-15T12:34:56+99:45", false, 0 },
+        { "2024-06-15T12:34:56+05:20", false, 0 },
+        { "2024-06-15T12:34:56+05:60", false, 0 },
+        { "2024-06-15T12:34:56+5:00", false, 0 },
+        { "2024-06-15T12:34:56+05:", false, 0 },
+        { "2024-06-15T12:34:56+", false, 0 },
+        { "2024-06-15T12:34:56.", false, 0 },
+        { "2024-06-15T12:34:56Zx", false, 0 },
+        { "2024-06-15T12:34:56 ", false, 0 },
+        { "2024-02-29T00:00:00", true, 0 },
+        { "2023-02-29T00:00:00", false, 0 },
+        { "2024-04-31T00:00:00", false, 0 },
+        { "2024-00-10T00:00:00", false, 0 },
+        { "2024-13-10T00:00:00", false, 0 },
+        { "2024-06-00T00:00:00", false, 0 },
+        { "2024-06-15T24:00:00", false, 0 },
+        { "2024-06-15T23:60:00", false, 0 },
+        { "2024-06-15T23:59:60", false, 0 }, // The RTC can't hold a leap second
+        { "1999-12-31T23:59:59", false, 0 },
+        { "2100-01-01T00:00:00", false, 0 },
+        { "2024-6-15T12:34:56", false, 0 },
+        { "2024/06/15T12:34:56", false, 0 },
+        { "2024-06-15X12:34:56", false, 0 },
+        { "", false, 0 },
+    };
+    for (const auto &c : cases)
+    {
+        bool accepted = checkParse8601(c.text, time, quarterHours);
+        CHECK(accepted == c.accepted, "\"%s\" %s", c.text, accepted ? "accepted" : "refused");
+        if (accepted && c.accepted)
+            CHECK(quarterHours == c.quarterHours, "\"%s\" parsed to time zone %d, expected %d", c.text, quarterHours, c.quarterHours);
+    }
+
+    // Cut short, a string only parses where one of the optional parts could end
+    const char full[] = "2024-06-15T12:34:56.78+05:30";
+    for (size_t length = 0; length <= strlen(full); length++)
+    {
+        char truncated[sizeof(full)];
+        memcpy(truncated, full, length);
+        truncated[length] = '\0';
+        bool expected = (length == 19) || (length == 21) || (length == 22) || (length == 25) || (length == 28);
+        CHECK(checkParse8601(truncated, time, quarterHours) == expected, "\"%s\" %s", truncated, expected ? "refused" : "accepted");
+    }
+
+    // Random damage to valid strings: whatever is accepted has to make sense
+    uint32_t accepted = 0;
+    for (uint32_t run = 0; run < fuzzRuns; run++)
+    {
+        char text[48];
+        randomTime(time);
+        int8_t zone = (int8_t)randomNumber(113) - 56;
+        uint8_t absZone = (zone < 0) ? -zone : zone;
+        int length = snprintf(text, sizeof(text), "20%02X-%02X-%02XT%02X:%02X:%02X.%02u%c%02d:%02d", time[TIME_YEAR], time[TIME_MONTH],
+                              time[TIME_DATE], time[TIME_HOURS], time[TIME_MINUTES], time[TIME_SECONDS], (unsigned)randomNumber(100),
+                              (zone < 0) ? '-' : '+', absZone / 4, (absZone % 4) * 15);
+        for (uint32_t edits = 1 + randomNumber(3); edits > 0; edits--)
+        {
+            uint32_t at = randomNumber(length + 1);
+            switch (randomNumber(4))
+            {
+            case 0: // Replace a character, often with one that looks right
+                if (at < (uint32_t)length)
+                    text[at] = randomNumber(2) ? "0123456789-:T+Z., "[randomNumber(18)] : (char)(1 + randomNumber(255));
+                break;
+            case 1: // Delete one
+                if (at < (uint32_t)length)
+                {
+                    memmove(text + at, text + at + 1, length - at);
+                    length--;
+                }
+                break;
+            case 2: // Insert one
+                if (length + 2 < (int)sizeof(text))
+                {
+                    memmove(text + at + 1, text + at, length - at + 1);
+                    text[at] = "0123456789-:T+Z., "[randomNumber(18)];
+                    length++;
+                }
+                break;
+            default: // Truncate
+                text[at] = '\0';
+                length = at;
+                break;
+            }
+        }
+        if (checkParse8601(text, time, quarterHours))
+            accepted++;
+    }
+    printf("  %lu of the mutated strings were still valid\n", (unsigned long)accepted);
+
+    static const char* const formats[] = { "2024-06-15T12:34:56", "2024-06-15T12:34:56Z", "2024-06-15T12:34:56.78+05:30", "2024-06-15T12:34:56x" };
+    for (const char* text : formats)
+    {
+        const uint32_t parses = 1000000;
+        bool hasTimeZone;
+        uint32_t ok = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < parses; i++)
+            ok += RV8803::parseTime8601(text, time, quarterHours, hasTimeZone);
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / parses;
+        printf("  parseTime8601(\"%s\")%*s %6.1f ns %7.1f MB/s%s\n", text, (int)(28 - strlen(text)), "", nanos, strlen(text) * 1000.0 / nanos,
+               ok ? "" : " (refused)");
+    }
+}
+
+// Several threads, each with its own RV8803, share Wire behind one std::recursive_mutex given to setLockCallbacks().
+// Two read the time as fast as they can: every snapshot must be a time the RTC held while it was read, so none was
+// torn or read from the wrong registers by another thread moving the register pointer. Two others set and clear
+// their own bit in CONTROL by read-modify-write: the bit must be set straight afterwards, so no update was lost.
+// Prints how long each thread spent waiting for the lock
+struct ContentionLock
+{
+    std::recursive_mutex mutex;
+};
+
+static thread_local double lockWaitNanos = 0;
+static thread_local double lockWaitMaxNanos = 0;
+static thread_local uint32_t lockTakes = 0;
+
+static void contentionLock(void* context)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    static_cast<ContentionLock*>(context)->mutex.lock();
+    double waited = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    lockWaitNanos += waited;
+    if (waited > lockWaitMaxNanos)
+        lockWaitMaxNanos = waited;
+    lockTakes++;
+}
+
+static void contentionUnlock(void* context)
+{
+    static_cast<ContentionLock*>(context)->mutex.unlock();
+}
+
+struct ContentionReport
+{
+    const char* name;
+    uint32_t bad;
+    uint32_t takes;
+    double waitNanos;
+    double maxWaitNanos;
+    double runNanos;
+};
+
+static void contentionReader(ContentionLock* lock, uint32_t operations, ContentionReport* report)
+{
+    RV8803 reader;
+    reader.setLockCallbacks(contentionLock, contentionUnlock, lock);
+    CHECK(reader.begin(Wire), "begin failed");
+    reader.set24Hour();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < operations; i++)
+    {
+        int64_t before, after;
+        {
+            std::lock_guard<std::recursive_mutex> guard(lock->mutex);
+            before = Wire.getClockHundredths();
+        }
+        bool read = reader.updateTime();
+        {
+            std::lock_guard<std::recursive_mutex> guard(lock->mutex);
+            after = Wire.getClockHundredths();
+        }
+        CHECK(read, "updateTime failed");
+        if (!read || !checkSnapshot(before, after, report->name, true, reader))
+            report->bad++;
+    }
+    report->runNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    report->takes = lockTakes;
+    report->waitNanos = lockWaitNanos;
+    report->maxWaitNanos = lockWaitMaxNanos;
+}
+
+static void contentionWriter(ContentionLock* lock, uint32_t operations, uint8_t bit, ContentionReport* report)
+{
+    RV8803 writer;
+    writer.setLockCallbacks(contentionLock, contentionUnlock, lock);
+    CHECK(writer.begin(Wire), "begin failed");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < operations; i++)
+    {
+        bool enabled = writer.enableHardwareInterrupt(bit);
+        uint8_t control = writer.readRegister(RV8803_CONTROL);
+        CHECK(enabled, "enableHardwareInterrupt(%u) failed", bit);
+        if (!enabled || !(control & (1 << bit)))
+            report->bad++; // Another thread's read-modify-write put back the old value
+        CHECK(writer.disableHardwareInterrupt(bit), "disableHardwareInterrupt(%u) failed", bit);
+    }
+    report->runNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    report->takes = lockTakes;
+    report->waitNanos = lockWaitNanos;
+    report->maxWaitNanos = lockWaitMaxNanos;
+}
+
+static void testContention()
+{
+    const uint32_t operations = 100000;
+    printf("Contention: 2 readers and 2 read-modify-write writers on one bus, %lu operations each\n", (unsigned long)operations);
+    ContentionLock lock;
+    Wire.setClock(2024, 12, 31, 23, 58, 0, 0); // Two minutes of simulated time covers the year rollover
+    Wire.pokeRegister(RV8803_CONTROL, 0);
+    rtc.setLockCallbacks(contentionLock, contentionUnlock, &lock);
+
+    ContentionReport reports[4] = { { "reader 1", 0, 0, 0, 0, 0 }, { "reader 2", 0, 0, 0, 0, 0 }, { "writer TIE", 0, 0, 0, 0, 0 },
+                                    { "writer AIE", 0, 0, 0, 0, 0 } };
+    std::thread threads[4] = {
+        std::thread(contentionReader, &lock, operations, &reports[0]),
+        std::thread(contentionReader, &lock, operations, &reports[1]),
+        std::thread(contentionWriter, &lock, operations, TIMER_INTERRUPT, &reports[2]),
+        std::thread(contentionWriter, &lock, operations, ALARM_INTERRUPT, &reports[3]),
+    };
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (const ContentionReport &report : reports)
+    {
+        CHECK(report.bad == 0, "%s: %lu torn snapshots or lost updates", report.name, (unsigned long)report.bad);
+        printf("  %-10s %5lu bad %8lu locks %7.0f ns/op, waited %5.1f%% of the time, %7.0f ns/lock average, %9.0f ns longest\n",
+               report.name, (unsigned long)report.bad, (unsigned long)report.takes, report.runNanos / operations,
+               100.0 * report.waitNanos / report.runNanos, report.waitNanos / report.takes, report.maxWaitNanos);
+    }
+    rtc.setLockCallbacks(nullptr, nullptr, nullptr);
+}
+
+// Writes "$body*hh\r\n" into sentence, with the checksum of body
+static void nmeaSentence(char* sentence, size_t size, const char* body, bool lowerCase = false)
+{
+    uint8_t checksum = 0;
+    for (const char* c = body; *c != '\0'; c++)
+        checksum ^= *c;
+    snprintf(sentence, size, lowerCase ? "$%s*%02x\r\n" : "$%s*%02X\r\n", body, checksum);
+}
+
+// True if any character completed a time
+static bool feedNMEA(RV8803_NMEA &nmea, const char* text)
+{
+    bool newTime = false;
+    for (const char* c = text; *c != '\0'; c++)
+        newTime = nmea.process(*c) || newTime;
+    return newTime;
+}
+
+// Hands out a string a character at a time, like a serial port with a sentence waiting
+class StringStream : public Stream
+{
+public:
+    explicit StringStream(const char* text) : _text(text) {}
+    int available() override { return (int)strlen(_text); }
+    int read() override { return (*_text != '\0') ? *_text++ : -1; }
+    int peek() override { return (*_text != '\0') ? *_text : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    const char* _text;
+};
+
+static void testNMEA()
+{
+    printf("NMEA parser: RMC and ZDA fields, checksums and framing, and setting the time with and without a PPS pulse\n");
+    struct NMEACase
+    {
+        const char* body;
+        bool good;
+        uint16_t year; uint8_t month, date, hour, minute, second, hundredths;
+    };
+    static const NMEACase cases[] = {
+        { "GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,150624,003.1,W", true, 2024, 6, 15, 12, 35, 19, 0 },
+        { "GNRMC,235959.99,A,,,,,,,311224,,", true, 2024, 12, 31, 23, 59, 59, 99 },
+        { "GPRMC,000000,A,,,,,,,290224,,", true, 2024, 2, 29, 0, 0, 0, 0 }, // No fraction, leap day
+        { "GPRMC,120000.5,A,,,,,,,150624,,", true, 2024, 6, 15, 12, 0, 0, 50 }, // Tenths
+        { "GPRMC,120000.123,A,,,,,,,150624,,", true, 2024, 6, 15, 12, 0, 0, 12 }, // Milliseconds
+        { "GPRMC,120000.0000000000000,A,,,,,,,150624,,", true, 2024, 6, 15, 12, 0, 0, 0 }, // Longer than the field buffer
+        { "GPRMC,120000.00,V,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 }, // No fix
+        { "GPRMC,120000.00,A,,,,,,,,,", false, 0, 0, 0, 0, 0, 0, 0 }, // No date
+        { "GPRMC,,A,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 }, // No time
+        { "GPRMC,12000,A,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,240000.00,A,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,126000.00,A,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,120060.00,A,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,12a000.00,A,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,120000.00,A,,,,,,,320624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,120000.00,A,,,,,,,151324,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,120000.00,A,,,,,,,000624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPRMC,120000.00,A,,,,,,,290223,,", false, 0, 0, 0, 0, 0, 0, 0 }, // Not a leap year
+        { "GPRMC,120000.00,A,,,,,,,15064,,", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPZDA,201530.00,04,07,2024,00,00", true, 2024, 7, 4, 20, 15, 30, 0 },
+        { "GNZDA,235959.50,31,12,2099,,", true, 2099, 12, 31, 23, 59, 59, 50 },
+        { "GPZDA,,,,,,", false, 0, 0, 0, 0, 0, 0, 0 }, // No fix
+        { "GPZDA,201530.00,04,07,1999,00,00", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPZDA,201530.00,04,07,24,00,00", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPZDA,201530.00,31,02,2024,00,00", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPZDA,201530.00,4,07,2024,00,00", false, 0, 0, 0, 0, 0, 0, 0 }, // The date the last ZDA gave mustn't be used
+        { "GPZDA,201530.00,04,,2024,00,00", false, 0, 0, 0, 0, 0, 0, 0 },
+        { "GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,", false, 0, 0, 0, 0, 0, 0, 0 }, // Not a sentence with the date
+        { "GPRMCX,123519.00,A,,,,,,,150624,,", false, 0, 0, 0, 0, 0, 0, 0 },
+    };
+
+    char sentence[128];
+    char priming[64]; // A good time and date first, which mustn't leak into the next sentence
+    nmeaSentence(priming, sizeof(priming), "GPZDA,000000.00,01,01,2001,,");
+    uint8_t time[TIME_ARRAY_LENGTH];
+    for (const NMEACase &c : cases)
+    {
+        for (uint8_t lowerCase = 0; lowerCase < 2; lowerCase++)
+        {
+            RV8803_NMEA nmea;
+            CHECK(feedNMEA(nmea, priming) && nmea.getTime(time), "priming sentence rejected");
+            nmeaSentence(sentence, sizeof(sentence), c.body, lowerCase);
+            const char* variant = lowerCase ? " (lower case checksum)" : "";
+            bool newTime = feedNMEA(nmea, sentence);
+            CHECK(newTime == c.good, "%s%s: %s", c.body, variant, c.good ? "rejected" : "accepted");
+            CHECK(nmea.getChecksumErrorCount() == 0, "%s%s: counted as a checksum error", c.body, variant);
+            CHECK(nmea.getSentenceCount() == (c.good ? 2U : 1U), "%s%s: %lu sentences counted", c.body, variant,
+                  (unsigned long)nmea.getSentenceCount());
+            if (!newTime || !c.good)
+                continue;
+            CHECK(nmea.getTime(time), "%s%s: no time", c.body, variant);
+            bool same = (time[TIME_YEAR] == RV8803::DECtoBCD(c.year - 2000)) && (time[TIME_MONTH] == RV8803::DECtoBCD(c.month))
+                        && (time[TIME_DATE] == RV8803::DECtoBCD(c.date)) && (time[TIME_HOURS] == RV8803::DECtoBCD(c.hour))
+                        && (time[TIME_MINUTES] == RV8803::DECtoBCD(c.minute)) && (time[TIME_SECONDS] == RV8803::DECtoBCD(c.second))
+                        && (time[TIME_HUNDREDTHS] == RV8803::DECtoBCD(c.hundredths))
+                        && (time[TIME_WEEKDAY] == (1 << RV8803::dayOfWeek(c.year, c.month, c.date)));
+            CHECK(same, "%s%s: gave 20%02X-%02X-%02X %02X:%02X:%02X.%02X weekday %02X", c.body, variant, time[TIME_YEAR], time[TIME_MONTH],
+                  time[TIME_DATE], time[TIME_HOURS], time[TIME_MINUTES], time[TIME_SECONDS], time[TIME_HUNDREDTHS], time[TIME_WEEKDAY]);
+        }
+    }
+
+    // Checksums and framing
+    const char* good = "GPRMC,123519.00,A,,,,,,,150624,,";
+    RV8803_NMEA nmea;
+    nmeaSentence(sentence, sizeof(sentence), good);
+    char* star = strchr(sentence, '*');
+    star[2] = (star[2] == '0') ? '1' : '0';
+    CHECK(!feedNMEA(nmea, sentence) && (nmea.getChecksumErrorCount() == 1) && !nmea.getTime(time), "a wrong checksum was accepted");
+    star[1] = 'G';
+    CHECK(!feedNMEA(nmea, sentence) && (nmea.getChecksumErrorCount() == 1), "a checksum that isn't hex was accepted, or counted as wrong");
+    CHECK(!feedNMEA(nmea, "$GPRMC,123519.00,A,,,,,,,150624,,\r\n"), "a sentence without a checksum was accepted");
+    char restarted[160];
+    nmeaSentence(sentence, sizeof(sentence), good);
+    snprintf(restarted, sizeof(restarted), "$GPRMC,1235%s", sentence);
+    CHECK(feedNMEA(nmea, restarted), "a $ didn't restart the sentence");
+    CHECK(!feedNMEA(nmea, "junk\r\n,,,*00\r\n"), "noise between sentences was accepted");
+    CHECK(nmea.getSentenceCount() == 1, "%lu sentences counted", (unsigned long)nmea.getSentenceCount());
+
+    StringStream stream(restarted);
+    RV8803_NMEA streamed;
+    CHECK(streamed.update(stream) && (stream.available() == 0) && streamed.getTime(time), "update() didn't parse the stream");
+
+    // Setting the RTC
+    const uint8_t ppsPin = 7;
+    RV8803_NMEA empty;
+    CHECK(!rtc.setTimeFromNMEA(empty) && (rtc.getLastError() == RV8803_ERROR_INVALID_ARGUMENT), "set from a parser without a time");
+    CHECK(rtc.setTimeZoneQuarterHours(4), "setTimeZoneQuarterHours failed"); // UTC+01:00
+
+    RV8803_NMEA fresh;
+    nmeaSentence(sentence, sizeof(sentence), "GPRMC,235959.00,A,,,,,,,311224,,");
+    CHECK(feedNMEA(fresh, sentence), "sentence rejected");
+    CHECK(rtc.setTimeFromNMEA(fresh), "setTimeFromNMEA failed");
+    int64_t expected = ((int64_t)daysSince2000(2025, 1, 1) * 8640000) + (59 * 6000) + 5900; // 00:59:59 local
+    int64_t actual = Wire.getClockHundredths();
+    CHECK((actual >= expected) && (actual <= expected + 1), "set from NMEA to %lld, expected %lld", (long long)actual, (long long)expected);
+
+    // The sentence comes after the pulse that marked its time, once that pulse has ended and while it is still high.
+    // Either way the RTC must start the next second on the rising edge of the next pulse
+    simPulsePin = ppsPin;
+    nmeaSentence(sentence, sizeof(sentence), "GPRMC,120000.00,A,,,,,,,150624,,");
+    static const uint32_t sinceLastPulse[] = { 300000, 50000 };
+    for (uint32_t since : sinceLastPulse)
+    {
+        uint64_t nextPulse = simMicros() + 1000000 - since;
+        simPulseOffsetMicros = nextPulse % 1000000;
+        CHECK(feedNMEA(fresh, sentence), "sentence rejected");
+        CHECK(rtc.setTimeFromNMEA(fresh, ppsPin), "setTimeFromNMEA with PPS failed");
+        expected = ((int64_t)daysSince2000(2024, 6, 15) * 8640000) + (13 * 360000) + 100 + (((int64_t)simMicros() - (int64_t)nextPulse) / 10000);
+        actual = Wire.getClockHundredths();
+        CHECK(llabs(actual - expected) <= 1, "set %u ms after a pulse to %lld, expected %lld", since / 1000, (long long)actual, (long long)expected);
+    }
+
+    CHECK(feedNMEA(fresh, sentence), "sentence rejected");
+    simAdvanceMicros(950000);
+    CHECK(!rtc.setTimeFromNMEA(fresh, ppsPin) && (rtc.getLastError() == RV8803_ERROR_INVALID_ARGUMENT), "set from a sentence too old to match a pulse");
+    CHECK(feedNMEA(fresh, sentence), "sentence rejected");
+    CHECK(!rtc.setTimeFromNMEA(fresh, ppsPin + 1) && (rtc.getLastError() == RV8803_ERROR_TIMEOUT), "set without a pulse");
+    CHECK((Wire.peekRegister(RV8803_CONTROL) & (1 << CONTROL_RESET)) == 0, "the clock was left stopped after the pulse timed out");
+
+    simPulsePin = 0xFF;
+    rtc.setTimeZoneQuarterHours(0);
+}
+
+// A snapshot of the time hundredths after 2000-01-01 00:00:00.00, decoded by the C library
+static RV8803_Snapshot snapshotAt(int64_t hundredths)
+{
+    time_t seconds = (time_t)((hundredths / 100) + SECONDS_FROM_1970_TO_2000);
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    RV8803_Snapshot snapshot;
+    snapshot.hundredths = hundredths % 100;
+    snapshot.seconds = tm.tm_sec;
+    snapshot.minutes = tm.tm_min;
+    snapshot.hours = tm.tm_hour;
+    snapshot.weekday = tm.tm_wday;
+    snapshot.date = tm.tm_mday;
+    snapshot.month = tm.tm_mon + 1;
+    snapshot.year = tm.tm_year + 1900;
+    return snapshot;
+}
+
+static bool sameSnapshot(const RV8803_Snapshot &a, const RV8803_Snapshot &b)
+{
+    return (a.hundredths == b.hundredths) && (a.seconds == b.seconds) && (a.minutes == b.minutes) && (a.hours == b.hours)
+           && (a.weekday == b.weekday) && (a.date == b.date) && (a.month == b.month) && (a.year == b.year);
+}
+
+static void testSnapshot()
+{
+    const uint32_t pairs = 200000;
+    printf("Snapshots: %lu random pairs for hundredthsSince(), compare() and addHundredths(), against gmtime_r()\n", (unsigned long)pairs);
+    const int64_t century = DAYS_2000_TO_2099 * 8640000LL;
+    const int32_t nearbyDays = 300; // Either side of the 248.55 days an int32_t of hundredths can hold
+
+    for (uint32_t pair = 0; pair < pairs; pair++)
+    {
+        int64_t a = ((int64_t)randomNumber(DAYS_2000_TO_2099) * 8640000) + randomNumber(8640000);
+        int64_t b;
+        if (pair & 1)
+            b = ((int64_t)randomNumber(DAYS_2000_TO_2099) * 8640000) + randomNumber(8640000); // Anywhere, mostly saturated
+        else
+            b = a + ((int64_t)randomNumber(2 * nearbyDays) - nearbyDays) * 8640000 + randomNumber(8640000); // Exact, or just saturated
+        if ((b < 0) || (b >= century))
+            b = a;
+        RV8803_Snapshot snapshotA = snapshotAt(a);
+        RV8803_Snapshot snapshotB = snapshotAt(b);
+
+        int64_t difference = a - b;
+        int32_t expected = (difference > INT32_MAX) ? INT32_MAX : ((difference < INT32_MIN) ? INT32_MIN : (int32_t)difference);
+        CHECK(snapshotA.hundredthsSince(snapshotB) == expected, "%lld - %lld gave %ld", (long long)a, (long long)b,
+              (long)snapshotA.hundredthsSince(snapshotB));
+        int8_t order = (a < b) ? -1 : ((a > b) ? 1 : 0);
+        CHECK(snapshotA.compare(snapshotB) == order, "compare(%lld, %lld) gave %d", (long long)a, (long long)b, snapshotA.compare(snapshotB));
+
+        // Moving a by the difference, clamped to what the argument can hold, must land where gmtime_r says, or refuse
+        // and leave the snapshot alone outside 2000-2099
+        int32_t delta = (int32_t)(b - a);
+        if ((b - a > INT32_MAX) || (b - a < INT32_MIN))
+            delta = (b > a) ? INT32_MAX : INT32_MIN;
+        if (pair & 2)
+            delta = (int32_t)randomNumber(0xFFFFFFFF); // Sometimes anywhere, to run off either end of the century
+        RV8803_Snapshot moved = snapshotA;
+        bool inRange = (a + delta >= 0) && (a + delta < century);
+        CHECK(moved.addHundredths(delta) == inRange, "%lld + %ld: %s", (long long)a, (long)delta, inRange ? "refused" : "accepted");
+        CHECK(sameSnapshot(moved, inRange ? snapshotAt(a + delta) : snapshotA), "%lld + %ld: landed on %04u-%02u-%02u %02u:%02u:%02u.%02u", (long long)a,
+              (long)delta, moved.year, moved.month, moved.date, moved.hours, moved.minutes, moved.seconds, moved.hundredths);
+
+        uint8_t time[TIME_ARRAY_LENGTH];
+        snapshotA.toTime(time);
+        CHECK(RV8803::isValidTime(time) && sameSnapshot(RV8803_Snapshot::fromTime(time), snapshotA), "%lld: toTime() and fromTime() don't round trip",
+              (long long)a);
+    }
+
+    // The edges of saturation, and of the century
+    const int64_t middle = century / 2;
+    CHECK(snapshotAt(middle + INT32_MAX).hundredthsSince(snapshotAt(middle)) == INT32_MAX, "INT32_MAX apart");
+    CHECK(snapshotAt(middle + INT32_MAX - 1).hundredthsSince(snapshotAt(middle)) == INT32_MAX - 1, "INT32_MAX - 1 apart");
+    CHECK(snapshotAt(middle).hundredthsSince(snapshotAt(middle + INT32_MAX)) == -INT32_MAX, "-INT32_MAX apart");
+    CHECK(snapshotAt(middle).hundredthsSince(snapshotAt(middle + INT32_MAX + 2)) == INT32_MIN, "INT32_MIN - 1 apart");
+    RV8803_Snapshot last = snapshotAt(century - 1);
+    CHECK(!last.addHundredths(1) && sameSnapshot(last, snapshotAt(century - 1)), "moved past 2099-12-31 23:59:59.99");
+    RV8803_Snapshot first = snapshotAt(0);
+    CHECK(!first.addHundredths(-1) && sameSnapshot(first, snapshotAt(0)), "moved before 2000-01-01");
+
+    // Filled in by updateTime(), and not before
+    RV8803 fresh;
+    CHECK(!fresh.getSnapshot().isSet(), "a snapshot before updateTime() is set");
+    CHECK(fresh.begin(Wire), "begin failed");
+    Wire.setClock(2024, 2, 29, 23, 59, 59, 0);
+    int64_t before = Wire.getClockHundredths();
+    CHECK(fresh.updateTime(), "updateTime failed");
+    RV8803_Snapshot read = fresh.getSnapshot();
+    int64_t since = snapshotAt(before).hundredthsSince(snapshotAt(0));
+    CHECK(read.isSet() && (read.compare(snapshotAt(before)) >= 0) && (read.hundredthsSince(snapshotAt(0)) - since <= 1) && (read.weekday == 4),
+          "getSnapshot() gave %04u-%02u-%02u %02u:%02u:%02u.%02u weekday %u", read.year, read.month, read.date, read.hours, read.minutes,
+          read.seconds, read.hundredths, read.weekday);
+}
+
+// Seconds since 1970 of a UTC time, from the C library
+static int64_t utcEpoch(uint16_t year, uint8_t month, uint8_t date, uint8_t hour, uint8_t minute)
+{
+    struct tm tm = {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = date;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    return timegm(&tm);
+}
+
+static void testNextAlarm()
+{
+    printf("Next alarm: no snapshot, failed read, and alarms past midnight, month end and year end\n");
+    rtc.setRetryPolicy(RV8803_DEFAULT_RETRIES, RV8803_DEFAULT_BACKOFF_US, RV8803_DEFAULT_DEADLINE_US);
+    uint32_t epoch;
+    Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+
+    RV8803 fresh;
+    CHECK(fresh.begin(Wire), "begin failed");
+    CHECK(fresh.setItemsToMatchForAlarm(true, true, false, false) && fresh.setAlarmMinutes(30) && fresh.setAlarmHours(12), "setting the alarm failed");
+    CHECK(!fresh.getNextAlarmEpoch(epoch), "getNextAlarmEpoch() answered before the first updateTime()");
+    CHECK(fresh.updateTime() && fresh.getNextAlarmEpoch(epoch), "getNextAlarmEpoch() failed after updateTime()");
+    Wire.failNext = 100;
+    CHECK(!fresh.updateTime(), "updateTime() succeeded through bus errors");
+    Wire.failNext = 0;
+    CHECK(!fresh.getNextAlarmEpoch(epoch), "getNextAlarmEpoch() answered after a failed updateTime()");
+
+    struct AlarmCase
+    {
+        const char* name;
+        uint16_t year; uint8_t month, date, hour, minute; // Now
+        bool minuteAlarm, hourAlarm, weekdayAlarm, dateAlarm;
+        uint8_t alarmMinute, alarmHour, alarmDay; // alarmDay is a date, or a weekday mask
+        int8_t quarterHours;
+        uint16_t nextYear; uint8_t nextMonth, nextDate, nextHour, nextMinute; // Local time it goes off
+    };
+    static const AlarmCase cases[] = {
+        { "midnight", 2024, 6, 15, 23, 45, true, true, false, false, 5, 0, 0, 0, 2024, 6, 16, 0, 5 },
+        { "minute only, at midnight", 2024, 6, 15, 23, 59, true, false, false, false, 0, 0, 0, 0, 2024, 6, 16, 0, 0 },
+        { "hour only, past midnight", 2024, 6, 15, 23, 10, false, true, false, false, 0, 1, 0, 0, 2024, 6, 16, 1, 0 },
+        { "30 day month end", 2024, 4, 30, 23, 30, true, true, false, true, 15, 6, 1, 0, 2024, 5, 1, 6, 15 },
+        { "31st, skipping short months", 2024, 3, 31, 12, 0, true, true, false, true, 0, 12, 31, 0, 2024, 5, 31, 12, 0 },
+        { "leap day", 2024, 2, 28, 23, 59, true, true, false, true, 0, 0, 29, 0, 2024, 2, 29, 0, 0 },
+        { "no leap day", 2023, 2, 28, 23, 59, true, true, false, true, 0, 0, 29, 0, 2023, 3, 29, 0, 0 },
+        { "year end", 2024, 12, 31, 23, 59, true, true, false, false, 0, 0, 0, 0, 2025, 1, 1, 0, 0 },
+        { "year end by date", 2024, 12, 31, 8, 0, true, true, false, true, 0, 7, 1, 0, 2025, 1, 1, 7, 0 },
+        { "year end by weekday", 2024, 12, 31, 23, 0, true, true, true, false, 30, 9, 1 << 3, 0, 2025, 1, 1, 9, 30 }, // Wednesday
+        { "weekday next week", 2024, 12, 31, 10, 0, true, true, true, false, 0, 9, 1 << 2, 0, 2025, 1, 7, 9, 0 }, // Tuesday, just gone
+        { "year end in UTC+05:30", 2024, 12, 31, 23, 50, true, true, false, false, 0, 0, 0, 22, 2025, 1, 1, 0, 0 },
+        { "year end in UTC-08:00", 2024, 12, 31, 23, 50, true, true, false, false, 0, 0, 0, -32, 2025, 1, 1, 0, 0 },
+    };
+    for (const AlarmCase &c : cases)
+    {
+        Wire.setClock(c.year, c.month, c.date, c.hour, c.minute, 0, 0);
+        CHECK(rtc.setTimeZoneQuarterHours(c.quarterHours), "%s: setTimeZoneQuarterHours failed", c.name);
+        CHECK(rtc.setItemsToMatchForAlarm(c.minuteAlarm, c.hourAlarm, c.weekdayAlarm, c.dateAlarm) && rtc.setAlarmMinutes(c.alarmMinute) &&
+              rtc.setAlarmHours(c.alarmHour) && (c.dateAlarm ? rtc.setAlarmDate(c.alarmDay) : rtc.setAlarmWeekday(c.alarmDay)),
+              "%s: setting the alarm failed", c.name);
+        CHECK(rtc.updateTime(), "%s: updateTime failed", c.name);
+        bool found = rtc.getNextAlarmEpoch(epoch);
+        int64_t expected = utcEpoch(c.nextYear, c.nextMonth, c.nextDate, c.nextHour, c.nextMinute) - (c.quarterHours * 900L);
+        CHECK(found && (epoch == expected), "%s: next alarm %s%u, expected %lld", c.name, found ? "" : "(none) ", found ? epoch : 0,
+              (long long)expected);
+    }
+    rtc.setTimeZoneQuarterHours(0);
+}
+
+// Steps the simulated time 1 ms at a time until the countdown timer fires, and clears its flag. Returns the
+// milliseconds that took, or limitMillis if it didn't fire
+static uint32_t waitForTimer(uint32_t limitMillis)
+{
+    for (uint32_t elapsed = 0; elapsed < limitMillis; elapsed++)
+    {
+        Wire.getClockHundredths(); // Runs the clock
+        uint8_t flags = Wire.peekRegister(RV8803_FLAG);
+        if (flags & (1 << FLAG_TIMER))
+        {
+            Wire.pokeRegister(RV8803_FLAG, flags & ~(1 << FLAG_TIMER));
+            return elapsed;
+        }
+        simAdvanceMicros(1000);
+    }
+    return limitMillis;
+}
+
+static void testCountdownTimer()
+{
+    printf("Countdown timer: preset readback, and predicted expiry against the simulated countdown\n");
+    struct TimerCase
+    {
+        const char* name;
+        uint8_t frequency;
+        uint16_t ticks;
+        uint8_t second, hundredths; // When it starts
+        uint32_t firstMillis, periodMillis;
+    };
+    static const TimerCase cases[] = {
+        { "4096 Hz", COUNTDOWN_TIMER_FREQUENCY_4096_HZ, 410, 0, 37, 100, 100 }, // 100.1 ms
+        { "64 Hz", COUNTDOWN_TIMER_FREQUENCY_64_HZ, 32, 0, 37, 500, 500 },
+        { "1 Hz", COUNTDOWN_TIMER_FREQUENCY_1_HZ, 3, 0, 30, 2700, 3000 }, // The first period ends with a second
+        { "1/60 Hz", COUNTDOWN_TIMER_FREQUENCY_1_60TH_HZ, 2, 30, 0, 90000, 120000 }, // ... or a minute
+    };
+    const uint32_t toleranceMillis = 15; // The start and the reads are to the hundredth
+
+    for (const TimerCase &c : cases)
+    {
+        Wire.setClock(2024, 6, 15, 12, 0, c.second, c.hundredths);
+        CHECK(rtc.setCountdownTimerEnable(false) && rtc.setCountdownTimerFrequency(c.frequency) && rtc.setCountdownTimerClockTicks(c.ticks),
+              "%s: setting the timer failed", c.name);
+        Wire.pokeRegister(RV8803_FLAG, 0);
+        uint64_t startMicros = simMicros();
+        CHECK(rtc.setCountdownTimerEnable(true), "%s: starting the timer failed", c.name);
+        for (uint8_t expiry = 0; expiry < 3; expiry++)
+        {
+            simAdvanceMicros(((expiry == 0) ? c.firstMillis : c.periodMillis) * 500ULL); // Half way
+            uint32_t remainingMillis = 0, epoch = 0;
+            bool found = rtc.getCountdownTimerRemainingMillis(remainingMillis) && rtc.getCountdownTimerExpiryEpoch(epoch);
+            CHECK(found, "%s: no prediction for expiry %u", c.name, expiry);
+            CHECK(rtc.getCountdownTimerClockTicks() == c.ticks, "%s: read %u ticks, not the preset %u", c.name, rtc.getCountdownTimerClockTicks(), c.ticks);
+            uint32_t waited = waitForTimer(c.periodMillis * 2);
+            CHECK(waited + toleranceMillis >= remainingMillis && waited <= remainingMillis + toleranceMillis,
+                  "%s: expiry %u predicted in %u ms, fired after %u ms", c.name, expiry, remainingMillis, waited);
+            int64_t firedEpoch = ((Wire.getClockHundredths() + 50) / 100) + SECONDS_FROM_1970_TO_2000;
+            CHECK(found && (llabs(firedEpoch - epoch) <= 1), "%s: expiry %u predicted at epoch %u, fired at %lld", c.name, expiry, epoch, (long long)firedEpoch);
+            if (expiry == 0)
+            {
+                uint32_t firstMillis = (uint32_t)((simMicros() - startMicros) / 1000);
+                CHECK(firstMillis + toleranceMillis >= c.firstMillis && firstMillis <= c.firstMillis + toleranceMillis,
+                      "%s: first fired after %u ms, not %u", c.name, firstMillis, c.firstMillis);
+            }
+        }
+    }
+
+    uint32_t remainingMillis;
+    RV8803 other;
+    CHECK(other.begin(Wire), "begin failed");
+    CHECK(!other.getCountdownTimerRemainingMillis(remainingMillis), "predicted a timer started by another RV8803");
+    CHECK(rtc.setEpoch(1718452800UL, true) && !rtc.getCountdownTimerRemainingMillis(remainingMillis), "predicted a timer started before a time set");
+    CHECK(rtc.setCountdownTimerEnable(false) && !rtc.getCountdownTimerRemainingMillis(remainingMillis), "predicted a stopped timer");
+
+    Wire.pokeRegister(RV8803_TIMER_1, 0xA0); // GPX bits
+    CHECK(rtc.setCountdownTimerClockTicks(0x123) && (Wire.peekRegister(RV8803_TIMER_1) == 0xA1) && (rtc.getCountdownTimerClockTicks() == 0x123),
+          "the GPX bits were lost or read back as ticks");
+    Wire.pokeRegister(RV8803_TIMER_1, 0);
+}
+
+// The OFFSET register as signed steps of 0.2384 ppm
+static int8_t offsetStepsNow()
+{
+    uint8_t offset = Wire.peekRegister(RV8803_OFFSET) & 0x3F;
+    return (offset & 0x20) ? (int8_t)(offset | 0xC0) : (int8_t)offset;
+}
+
+static void testSlew()
+{
+    printf("Slewing: OFFSET held at its limit for the predicted time, the correction it makes, and the baseline restored\n");
+    rtc.setRetryPolicy(RV8803_DEFAULT_RETRIES, RV8803_DEFAULT_BACKOFF_US, RV8803_DEFAULT_DEADLINE_US);
+    struct SlewCase
+    {
+        int8_t baseline; // Steps
+        int32_t correctionMillis;
+    };
+    static const SlewCase cases[] = {
+        { 0, 100 }, { 0, -100 }, { 10, 250 }, { -20, -40 }, { 31, 7 }, { -32, -3 }, { 5, 1 },
+    };
+    for (const SlewCase &c : cases)
+    {
+        CHECK(rtc.setCalibrationOffsetPPB((c.baseline * 2384L) / 10) && (offsetStepsNow() == c.baseline), "setting the baseline %d failed", c.baseline);
+        CHECK(rtc.startSlew(c.correctionMillis) && rtc.isSlewing(), "%d ms from %d: startSlew failed", c.correctionMillis, c.baseline);
+        int8_t limit = (c.correctionMillis > 0) ? -32 : 31;
+        uint32_t rateSteps = abs(limit - c.baseline);
+        uint64_t expectedDuration = ((uint64_t)abs(c.correctionMillis) * 10000000000ULL) / (rateSteps * 2384);
+        CHECK(offsetStepsNow() == limit, "%d ms from %d: OFFSET is %d, not %d", c.correctionMillis, c.baseline, offsetStepsNow(), limit);
+        CHECK(rtc.getSlewDurationMillis() == expectedDuration, "%d ms from %d: duration %u ms, expected %llu", c.correctionMillis, c.baseline,
+              rtc.getSlewDurationMillis(), (unsigned long long)expectedDuration);
+
+        // Step through it, adding up what the offset does to the clock while it is held
+        uint32_t stepMillis = (uint32_t)(expectedDuration / 1000) + 1;
+        double achievedMillis = 0;
+        uint32_t elapsedMillis = 0;
+        while (rtc.isSlewing() && (elapsedMillis <= expectedDuration + stepMillis))
+        {
+            int8_t steps = offsetStepsNow();
+            CHECK(steps == limit, "%d ms from %d: OFFSET moved to %d during the slew", c.correctionMillis, c.baseline, steps);
+            simAdvanceMicros(stepMillis * 1000ULL);
+            elapsedMillis += stepMillis;
+            achievedMillis += (double)stepMillis * (c.baseline - steps) * 2.384e-7; // Lower steps run the clock faster
+            CHECK(rtc.serviceSlew(), "%d ms from %d: serviceSlew failed", c.correctionMillis, c.baseline);
+            if (rtc.isSlewing())
+            {
+                double expected = c.correctionMillis * (1.0 - (double)elapsedMillis / expectedDuration);
+                int32_t remaining = rtc.getSlewRemainingCorrectionMillis();
+                CHECK(fabs(remaining - expected) <= 1.0, "%d ms from %d: %d ms left after %u ms, expected %.1f", c.correctionMillis, c.baseline,
+                      remaining, elapsedMillis, expected);
+            }
+        }
+        CHECK(!rtc.isSlewing() && (offsetStepsNow() == c.baseline), "%d ms from %d: OFFSET left at %d after %u ms", c.correctionMillis, c.baseline,
+              offsetStepsNow(), elapsedMillis);
+        CHECK(fabs(achievedMillis - c.correctionMillis) <= (abs(c.correctionMillis) / 500.0) + 0.01, "%d ms from %d: corrected %.2f ms",
+              c.correctionMillis, c.baseline, achievedMillis);
+        CHECK(rtc.getSlewRemainingCorrectionMillis() == 0 && rtc.getSlewRemainingMillis() == 0, "%d ms from %d: a finished slew has some left",
+              c.correctionMillis, c.baseline);
+    }
+
+    // Stopped half way: the baseline comes back and the correction left stays put
+    CHECK(rtc.setCalibrationOffsetPPB(0) && rtc.startSlew(-60), "startSlew failed");
+    simAdvanceMicros(rtc.getSlewDurationMillis() * 500ULL);
+    CHECK(rtc.serviceSlew() && rtc.isSlewing(), "the slew ended early");
+    CHECK(rtc.stopSlew() && !rtc.isSlewing() && (offsetStepsNow() == 0), "stopSlew didn't restore the baseline");
+    int32_t left = rtc.getSlewRemainingCorrectionMillis();
+    simAdvanceMicros(60000000);
+    CHECK(abs(left + 30) <= 1 && rtc.getSlewRemainingCorrectionMillis() == left, "%d ms left after stopping half way through -60 ms, then %d", left,
+          rtc.getSlewRemainingCorrectionMillis());
+
+    // A new slew restores the old baseline before taking its own
+    CHECK(rtc.setCalibrationOffsetPPB(-477) && rtc.startSlew(20) && rtc.startSlew(-20) && (offsetStepsNow() == 31), "restarting the slew failed");
+    CHECK(rtc.stopSlew() && (offsetStepsNow() == -2), "a restarted slew took the first slew's limit as its baseline (OFFSET %d)", offsetStepsNow());
+
+    // The restore fails on the bus: still slewing, and the next serviceSlew() finishes it
+    CHECK(rtc.setCalibrationOffsetPPB(0) && rtc.startSlew(5), "startSlew failed");
+    simAdvanceMicros((rtc.getSlewDurationMillis() + 1) * 1000ULL);
+    Wire.failNext = 100;
+    CHECK(!rtc.serviceSlew() && rtc.isSlewing() && (offsetStepsNow() == -32), "a failed restore ended the slew");
+    Wire.failNext = 0;
+    CHECK(rtc.serviceSlew() && !rtc.isSlewing() && (offsetStepsNow() == 0), "the restore wasn't retried");
+
+    // Nothing to do, and nothing that can be done
+    CHECK(rtc.startSlew(0) && !rtc.isSlewing() && (offsetStepsNow() == 0), "a slew of 0 ms did something");
+    CHECK(rtc.setCalibrationOffsetPPB(-7629) && !rtc.startSlew(10) && (rtc.getLastError() == RV8803_ERROR_INVALID_ARGUMENT) && (offsetStepsNow() == -32),
+          "a slew from the limit toward it was accepted");
+    CHECK(rtc.setCalibrationOffsetPPB(0) && !rtc.startSlew(INT32_MAX) && (rtc.getLastError() == RV8803_ERROR_INVALID_ARGUMENT) && (offsetStepsNow() == 0),
+          "a slew longer than millis() can count was accepted");
+    CHECK(!rtc.isSlewing(), "a rejected slew left one running");
+}
+
+// Where each RV8803_Config register lives on the chip
+static const uint8_t configAddresses[RV8803_CONFIG_LENGTH] = {
+    RV8803_RAM, RV8803_MINUTES_ALARM, RV8803_HOURS_ALARM, RV8803_WEEKDAYS_DATE_ALARM, RV8803_TIMER_0, RV8803_TIMER_1,
+    RV8803_EXTENSION, RV8803_FLAG, RV8803_CONTROL, RV8803_OFFSET, RV8803_EVENT_CONTROL,
+};
+
+// A configuration that touches every register in the blob, set through the library
+static bool configureRTC()
+{
+    return rtc.setTimeZoneQuarterHours(-14) && rtc.setItemsToMatchForAlarm(true, true, false, true) && rtc.setAlarmMinutes(45) &&
+           rtc.setAlarmHours(6) && rtc.setAlarmDate(17) && rtc.setCountdownTimerFrequency(COUNTDOWN_TIMER_FREQUENCY_64_HZ) &&
+           rtc.setCountdownTimerClockTicks(0x2A5) && rtc.setCountdownTimerEnable(true) && rtc.setPeriodicTimeUpdateFrequency(true) &&
+           rtc.setCalibrationOffsetPPB(-954) && rtc.setEVIEdgeDetection(true) && rtc.setEVIDebounceTime(2) && rtc.setEVIEventCapture(true);
+}
+
+// Runs operation and counts its bus traffic
+template <typename Operation>
+static bool countTraffic(Operation operation, uint32_t &transactions, uint32_t &bytes)
+{
+    uint32_t startTransactions = Wire.transactions, startBytes = Wire.bytes;
+    bool result = operation();
+    transactions = Wire.transactions - startTransactions;
+    bytes = Wire.bytes - startBytes;
+    return result;
+}
+
+static void testConfig()
+{
+    printf("Configuration blob: CRC, read and write round trip, minimal writes and diffConfig()\n");
+    rtc.setRetryPolicy(RV8803_DEFAULT_RETRIES, RV8803_DEFAULT_BACKOFF_US, RV8803_DEFAULT_DEADLINE_US);
+    Wire.reset();
+    Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+    CHECK(rtc.begin(Wire) && configureRTC(), "configuring the RTC failed");
+
+    RV8803_Config golden;
+    CHECK(rtc.readConfig(golden) && golden.isValid() && (golden.version == RV8803_CONFIG_VERSION), "readConfig gave an invalid blob");
+    for (uint8_t i = 0; i < RV8803_CONFIG_LENGTH; i++)
+        CHECK(golden.registers[i] == Wire.peekRegister(configAddresses[i]), "register %u read as 0x%02X, the RTC holds 0x%02X", i,
+              golden.registers[i], Wire.peekRegister(configAddresses[i]));
+
+    // Every single bit error is caught, and updateCRC() accepts the change
+    uint8_t* blob = (uint8_t*)&golden;
+    for (uint8_t byte = 0; byte < sizeof(RV8803_Config); byte++)
+    {
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            RV8803_Config damaged = golden;
+            ((uint8_t*)&damaged)[byte] ^= 1 << bit;
+            CHECK(!damaged.isValid(), "byte %u bit %u flipped, still valid", byte, bit);
+            damaged.updateCRC();
+            CHECK(damaged.isValid() == (byte != 0), "byte %u bit %u flipped, then updateCRC(): %svalid", byte, bit, damaged.isValid() ? "" : "in");
+        }
+    }
+    CHECK(blob[0] == RV8803_CONFIG_VERSION, "the version isn't the first byte");
+
+    RV8803_Config damaged = golden;
+    damaged.crc ^= 0x01;
+    uint32_t transactions, bytes;
+    CHECK(!countTraffic([&] { return rtc.writeConfig(damaged); }, transactions, bytes) && (rtc.getLastError() == RV8803_ERROR_INVALID_ARGUMENT) &&
+          (transactions == 0), "writeConfig took a blob with a bad CRC (%u transactions)", transactions);
+
+    // Round trip through a power-on reset
+    Wire.reset();
+    Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+    uint16_t differences = 0;
+    CHECK(rtc.diffConfig(golden, differences) && (differences != 0), "diffConfig found no differences after a reset");
+    CHECK(rtc.writeConfig(golden) && rtc.diffConfig(golden, differences) && (differences == 0), "writeConfig didn't restore the blob (0x%03X)",
+          differences);
+    RV8803_Config readBack;
+    CHECK(rtc.readConfig(readBack), "readConfig failed");
+    for (uint8_t i = 0; i < RV8803_CONFIG_LENGTH; i++)
+        CHECK((i == CONFIG_FLAG) || (readBack.registers[i] == golden.registers[i]), "register %u came back as 0x%02X, not 0x%02X", i,
+              readBack.registers[i], golden.registers[i]);
+
+    // Writing what is already there only reads; one change is one more transaction of 3 bytes, and a run of
+    // neighbours is one burst
+    uint32_t readTransactions, readBytes;
+    CHECK(countTraffic([&] { return rtc.writeConfig(golden); }, readTransactions, readBytes), "writeConfig failed");
+    struct ChangeCase
+    {
+        const char* name;
+        uint8_t first, count;
+        uint32_t writes, writeBytes;
+    };
+    static const ChangeCase changes[] = {
+        { "time zone", CONFIG_RAM, 1, 1, 3 },
+        { "alarm minutes and hours", CONFIG_MINUTES_ALARM, 2, 1, 4 },
+        { "offset", CONFIG_OFFSET, 1, 1, 3 },
+        { "event control", CONFIG_EVENT_CONTROL, 1, 1, 3 },
+        { "offset and event control", CONFIG_OFFSET, 2, 2, 6 },
+        { "RAM to alarm date", CONFIG_RAM, 4, 1, 6 },
+    };
+    for (const ChangeCase &c : changes)
+    {
+        RV8803_Config changed = golden;
+        uint16_t expectedDifferences = 0;
+        for (uint8_t i = c.first; i < c.first + c.count; i++)
+        {
+            changed.registers[i] ^= 0x01;
+            expectedDifferences |= 1 << i;
+        }
+        changed.updateCRC();
+        CHECK(rtc.diffConfig(changed, differences) && (differences == expectedDifferences), "%s: diffConfig gave 0x%03X, not 0x%03X", c.name,
+              differences, expectedDifferences);
+        CHECK(countTraffic([&] { return rtc.writeConfig(changed); }, transactions, bytes), "%s: writeConfig failed", c.name);
+        CHECK((transactions == readTransactions + c.writes) && (bytes == readBytes + c.writeBytes), "%s: %u transactions and %u bytes, expected %u and %u",
+              c.name, transactions, bytes, readTransactions + c.writes, readBytes + c.writeBytes);
+        CHECK(rtc.diffConfig(changed, differences) && (differences == 0), "%s: still differs after writeConfig (0x%03X)", c.name, differences);
+        CHECK(rtc.writeConfig(golden), "%s: writing the golden blob back failed", c.name);
+    }
+
+    // FLAG is never compared or written, RESET and TEST never set
+    RV8803_Config dangerous = golden;
+    dangerous.registers[CONFIG_FLAG] = 0xFF;
+    dangerous.registers[CONFIG_CONTROL] |= 1 << CONTROL_RESET;
+    dangerous.registers[CONFIG_EXTENSION] |= 1 << EXTENSION_TEST;
+    dangerous.updateCRC();
+    CHECK(rtc.diffConfig(dangerous, differences) && (differences == ((1 << CONFIG_CONTROL) | (1 << CONFIG_EXTENSION))),
+          "diffConfig gave 0x%03X", differences);
+    Wire.pokeRegister(RV8803_FLAG, 0);
+    CHECK(rtc.writeConfig(dangerous), "writeConfig failed");
+    CHECK((Wire.peekRegister(RV8803_FLAG) == 0) && ((Wire.peekRegister(RV8803_CONTROL) & (1 << CONTROL_RESET)) == 0) &&
+          ((Wire.peekRegister(RV8803_EXTENSION) & (1 << EXTENSION_TEST)) == 0), "writeConfig wrote FLAG, RESET or TEST");
+
+    // A new timer value while it runs: stopped, written and started again, so it counts from the new preset
+    RV8803_Config retimed = golden;
+    retimed.registers[CONFIG_TIMER_0] = 32; // Half a second at 64 Hz
+    retimed.registers[CONFIG_TIMER_1] = 0;
+    retimed.updateCRC();
+    simAdvanceMicros(1000000);
+    Wire.pokeRegister(RV8803_FLAG, 0);
+    CHECK(rtc.writeConfig(retimed) && (Wire.peekRegister(RV8803_EXTENSION) & (1 << EXTENSION_TE)), "writeConfig didn't restart the timer");
+    uint32_t waited = waitForTimer(2000);
+    CHECK(waited >= 490 && waited <= 510, "the rewritten timer fired after %u ms, not 500", waited);
+
+    Wire.failNext = 100;
+    CHECK(!rtc.readConfig(readBack) && !rtc.writeConfig(golden) && !rtc.diffConfig(golden, differences), "the blob functions succeeded through bus errors");
+    Wire.failNext = 0;
+    CHECK(rtc.writeConfig(golden) && rtc.setCountdownTimerEnable(false) && rtc.setTimeZoneQuarterHours(0), "cleaning up failed");
+}
+
+static void testBootProfile()
+{
+    printf("begin(profile): warm, reconfigured and cold boots, and what each costs on the bus\n");
+    Wire.reset();
+    Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+    RV8803_Config golden;
+    CHECK(rtc.begin(Wire) && configureRTC() && rtc.readConfig(golden), "configuring the RTC failed");
+
+    // What a warm boot may cost: the address probe and the two reads of readConfig()
+    uint32_t probeTransactions, probeBytes, transactions, bytes;
+    RV8803 probe;
+    RV8803_Config current;
+    CHECK(countTraffic([&] { return probe.begin(Wire) && probe.readConfig(current); }, probeTransactions, probeBytes), "probing failed");
+
+    struct BootCase
+    {
+        const char* name;
+        uint8_t address, value; // Poked before the boot, unless address is 0
+        bool powerOn; // Wire.reset() and V2F first
+        RV8803_BootPath path;
+        uint32_t writes, writeBytes; // Bus traffic beyond a warm boot's
+    };
+    static const BootCase cases[] = {
+        { "warm", 0, 0, false, RV8803_BOOT_WARM, 0, 0 },
+        { "offset drifted", RV8803_OFFSET, 0x05, false, RV8803_BOOT_RECONFIGURED, 1, 3 },
+        { "alarm lost", RV8803_MINUTES_ALARM, 0x00, false, RV8803_BOOT_RECONFIGURED, 1, 3 },
+        { "timer stopped", RV8803_EXTENSION, 0x00, false, RV8803_BOOT_RECONFIGURED, 1, 3 },
+        { "flags alone", RV8803_FLAG, (1 << FLAG_ALARM) | (1 << FLAG_V1F), false, RV8803_BOOT_WARM, 0, 0 },
+        { "power on", 0, 0, true, RV8803_BOOT_COLD, 0, 0 },
+    };
+    for (const BootCase &c : cases)
+    {
+        if (c.powerOn)
+        {
+            Wire.reset();
+            Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+            Wire.pokeRegister(RV8803_FLAG, 1 << FLAG_V2F);
+        }
+        if (c.address != 0)
+            Wire.pokeRegister(c.address, c.value);
+        uint8_t flags = Wire.peekRegister(RV8803_FLAG);
+
+        RV8803 booted;
+        RV8803_BootPath path = RV8803_BOOT_FAILED;
+        countTraffic([&] { return (path = booted.begin(golden, Wire)) != RV8803_BOOT_FAILED; }, transactions, bytes);
+        CHECK(path == c.path, "%s: booted %d, expected %d", c.name, path, c.path);
+        if (c.powerOn)
+            CHECK(transactions > probeTransactions, "%s: a cold boot wrote nothing", c.name); // Everything the reset cleared
+        else
+            CHECK((transactions == probeTransactions + c.writes) && (bytes == probeBytes + c.writeBytes), "%s: %u transactions and %u bytes, expected %u and %u",
+                  c.name, transactions, bytes, probeTransactions + c.writes, probeBytes + c.writeBytes);
+        uint16_t differences = 0;
+        CHECK(booted.diffConfig(golden, differences) && (differences == 0), "%s: the RTC differs from the profile after booting (0x%03X)", c.name, differences);
+        CHECK(Wire.peekRegister(RV8803_FLAG) == flags, "%s: FLAG went from 0x%02X to 0x%02X", c.name, flags, Wire.peekRegister(RV8803_FLAG));
+        RV8803_TimeValidity expected = (flags & (1 << FLAG_V2F)) ? RV8803_TIME_INVALID : (flags & (1 << FLAG_V1F)) ? RV8803_TIME_DEGRADED : RV8803_TIME_TRUSTED;
+        CHECK(booted.getTimeValidity() == expected, "%s: time validity %d, expected %d", c.name, booted.getTimeValidity(), expected);
+        Wire.pokeRegister(RV8803_FLAG, 0);
+    }
+
+    // A profile with RESET or TEST set can't be written as it is, but must still match the RTC it was written to
+    RV8803_Config dangerous = golden;
+    dangerous.registers[CONFIG_CONTROL] |= 1 << CONTROL_RESET;
+    dangerous.registers[CONFIG_EXTENSION] |= 1 << EXTENSION_TEST;
+    dangerous.updateCRC();
+    RV8803 booted;
+    CHECK(booted.begin(dangerous, Wire) == RV8803_BOOT_WARM, "a profile with RESET and TEST set never boots warm");
+
+    RV8803_Config damaged = golden;
+    damaged.crc ^= 0x80;
+    CHECK((countTraffic([&] { return booted.begin(damaged, Wire) != RV8803_BOOT_FAILED; }, transactions, bytes) == false) &&
+          (booted.getLastError() == RV8803_ERROR_INVALID_ARGUMENT) && (transactions == 0), "a profile with a bad CRC was used (%u transactions)", transactions);
+    Wire.failNext = 100;
+    CHECK(booted.begin(golden, Wire) == RV8803_BOOT_FAILED, "booted through bus errors");
+    Wire.failNext = 0;
+    CHECK(rtc.setCountdownTimerEnable(false) && rtc.setTimeZoneQuarterHours(0), "cleaning up failed");
+}
+
+#ifdef RV8803_HAS_CHRONO
+static void testClock()
+{
+    printf("RV8803_Clock: now() against the simulated clock, from a cache, without touching the RV8803's snapshot\n");
+    const int8_t quarterHours = -20; // UTC-05:00
+    Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+    CHECK(rtc.setTimeZoneQuarterHours(quarterHours) && rtc.updateTime(), "setting up failed");
+    RV8803_Snapshot owned = rtc.getSnapshot();
+    rtc.setLockCallbacks(countingLock, countingUnlock, nullptr);
+    RV8803_Clock::attach(rtc, 1000);
+
+    simAdvanceMicros(1500000);
+    outerLocks = 0;
+    RV8803_Clock::time_point now = RV8803_Clock::now();
+    int64_t expected = Wire.getClockHundredths() + (SECONDS_FROM_1970_TO_2000 * 100) - (quarterHours * 900LL * 100);
+    CHECK(llabs(now.time_since_epoch().count() - expected) <= 1, "now() is %lld, the RTC says %lld", (long long)now.time_since_epoch().count(),
+          (long long)expected);
+    CHECK(outerLocks == 1, "now() took the bus lock %lu times to read the time and time zone", (unsigned long)outerLocks);
+    CHECK(rtc.getSnapshot().compare(owned) == 0, "now() changed the RV8803's snapshot");
+
+    // Within the staleness budget there is no bus traffic, and the time carries on with millis()
+    uint32_t transactions = Wire.transactions;
+    for (uint32_t call = 0; call < 900; call++)
+    {
+        simAdvanceMicros(1000);
+        now = RV8803_Clock::now();
+        expected = Wire.getClockHundredths() + (SECONDS_FROM_1970_TO_2000 * 100) - (quarterHours * 900LL * 100);
+        CHECK(llabs(now.time_since_epoch().count() - expected) <= 1, "now() is %lld from the cache, the RTC says %lld",
+              (long long)now.time_since_epoch().count(), (long long)expected);
+    }
+    CHECK(Wire.transactions == transactions, "now() used the bus %lu times within the staleness budget", (unsigned long)(Wire.transactions - transactions));
+    simAdvanceMicros(200000);
+    RV8803_Clock::now();
+    CHECK(Wire.transactions > transactions, "now() didn't read the RTC once the cache was stale");
+
+    std::chrono::system_clock::time_point system = RV8803_Clock::to_sys(now);
+    CHECK(RV8803_Clock::from_sys(system) == now, "to_sys() and from_sys() don't round trip");
+    CHECK(std::chrono::duration_cast<std::chrono::seconds>(system.time_since_epoch()).count() == now.time_since_epoch().count() / 100,
+          "to_sys() doesn't count from 1970");
+
+    CHECK(rtc.getSnapshot().compare(owned) == 0, "now() changed the RV8803's snapshot");
+    rtc.setLockCallbacks(nullptr, nullptr, nullptr);
+    CHECK(lockDepth == 0, "bus lock left held %d deep", lockDepth);
+    rtc.setTimeZoneQuarterHours(0);
+    RV8803_Clock::invalidate();
+}
+#endif
+
+// Collects what exportTrace() writes
+class TraceCapture : public Print
+{
+public:
+    using Print::write;
+    size_t write(uint8_t value) override
+    {
+        bytes.push_back(value);
+        return 1;
+    }
+    std::vector<uint8_t> bytes;
+};
+
+static void failOneRead(uint8_t)
+{
+    Wire.failNext = 1; // The address was acknowledged; now the data isn't there
+    Wire.beforeRead = nullptr;
+}
+
+static void testTrace()
+{
+    printf("Bus trace: replaying the library's own traffic, and the ring buffer wrapping at every size\n");
+    static uint8_t traceBuffer[16384];
+    TraceCapture capture;
+    std::vector<TraceRecord> records;
+    const char* error = nullptr;
+    ReplayReport report;
+    TwoWire sim;
+
+    // A replay must make the same bus traffic and see the same configuration registers as the run that recorded it
+    Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+    rtc.setTraceBuffer(traceBuffer, sizeof(traceBuffer));
+    uint32_t transactions = Wire.transactions;
+    uint32_t bytes = Wire.bytes;
+    CHECK(rtc.setTimeZoneQuarterHours(4) && rtc.setItemsToMatchForAlarm(true, true, false, false) && rtc.setAlarmMinutes(30) && rtc.setAlarmHours(7),
+          "setting the alarm failed");
+    CHECK(rtc.setCountdownTimerFrequency(COUNTDOWN_TIMER_FREQUENCY_64_HZ) && rtc.setCountdownTimerClockTicks(100) && rtc.setCountdownTimerEnable(true),
+          "starting the timer failed");
+    uint32_t injected = 0;
+    for (uint32_t poll = 0; poll < 300; poll++)
+    {
+        simAdvanceMicros(randomNumber(50000));
+        if (randomNumber(10) == 0)
+        {
+            Wire.failNext = 1;
+            injected++;
+        }
+        else if (randomNumber(10) == 0)
+        {
+            Wire.beforeRead = failOneRead;
+            injected++;
+        }
+        rtc.updateTime();
+        Wire.beforeRead = nullptr; // In case it wasn't a read
+        if ((poll % 50) == 0)
+            rtc.setEpoch(1718452800UL + poll, true);
+        rtc.serviceInterrupts();
+    }
+    RV8803_Config config;
+    CHECK(rtc.readConfig(config), "readConfig failed");
+    transactions = Wire.transactions - transactions;
+    bytes = Wire.bytes - bytes;
+    CHECK(rtc.exportTrace(capture) == capture.bytes.size(), "exportTrace() miscounted what it wrote");
+    CHECK(rtc.getTraceDroppedCount() == 0, "%lu records dropped from a big enough buffer", (unsigned long)rtc.getTraceDroppedCount());
+    CHECK(parseTrace(capture.bytes.data(), capture.bytes.size(), records, error), "the trace didn't parse: %s", error);
+    CHECK(records.size() == rtc.getTraceRecordCount(), "%lu records parsed, %u recorded", (unsigned long)records.size(), rtc.getTraceRecordCount());
+    replayTrace(records, sim, report);
+    CHECK((report.transactions == transactions) && (report.bytes == bytes), "replayed %lu transactions and %lu bytes, recorded %lu and %lu",
+          (unsigned long)report.transactions, (unsigned long)report.bytes, (unsigned long)transactions, (unsigned long)bytes);
+    CHECK(report.failed >= injected, "%lu failures replayed, %lu injected", (unsigned long)report.failed, (unsigned long)injected);
+    CHECK(report.registerMismatches == 0, "%lu configuration register bytes differed on replay, the first in record %ld",
+          (unsigned long)report.registerMismatches, (long)report.firstMismatch);
+    static const uint8_t configRegisters[] = { RV8803_RAM, RV8803_MINUTES_ALARM, RV8803_HOURS_ALARM, RV8803_WEEKDAYS_DATE_ALARM, RV8803_TIMER_0,
+                                               RV8803_TIMER_1, RV8803_EXTENSION, RV8803_CONTROL };
+    for (uint8_t reg : configRegisters)
+        CHECK(report.known[reg] && (report.registers[reg] == Wire.peekRegister(reg)), "register 0x%02X left at 0x%02X by the replay, 0x%02X by the run",
+              reg, report.registers[reg], Wire.peekRegister(reg));
+    printf("  %lu records, %lu transactions, %lu failed; %lu time and flag bytes read differently on replay\n", (unsigned long)report.records,
+           (unsigned long)report.transactions, (unsigned long)report.failed, (unsigned long)report.timeMismatches);
+    CHECK(rtc.setCountdownTimerEnable(false) && rtc.setTimeZoneQuarterHours(0), "cleaning up failed");
+
+    // Failed reads are recorded without data, and say how they failed
+    rtc.clearTrace();
+    uint8_t time[TIME_ARRAY_LENGTH];
+    Wire.failNext = 1;
+    CHECK(rtc.readMultipleRegisters(RV8803_HUNDREDTHS, time, TIME_ARRAY_LENGTH), "the retry failed");
+    Wire.beforeRead = failOneRead;
+    CHECK(rtc.readMultipleRegisters(RV8803_HUNDREDTHS, time, TIME_ARRAY_LENGTH), "the retry failed");
+    capture.bytes.clear();
+    rtc.exportTrace(capture);
+    CHECK(parseTrace(capture.bytes.data(), capture.bytes.size(), records, error) && (records.size() == 4), "expected 4 records");
+    if (records.size() == 4)
+    {
+        CHECK((records[0].result == RV8803_ERROR_NACK_ADDRESS) && records[0].data.empty() && (records[0].len == TIME_ARRAY_LENGTH),
+              "a NACKed read was recorded as result %u with %lu bytes", records[0].result, (unsigned long)records[0].data.size());
+        CHECK((records[2].result == RV8803_ERROR_SHORT_READ) && records[2].data.empty(), "a short read was recorded as result %u with %lu bytes",
+              records[2].result, (unsigned long)records[2].data.size());
+        CHECK((records[3].result == RV8803_SUCCESS) && (records[3].data.size() == TIME_ARRAY_LENGTH) && (memcmp(records[3].data.data(), time, TIME_ARRAY_LENGTH) == 0),
+              "a good read wasn't recorded with its data");
+    }
+
+    // Damaged traces are refused
+    CHECK(!parseTrace(capture.bytes.data(), capture.bytes.size() - 1, records, error), "a truncated trace parsed");
+    capture.bytes[0] = 'X';
+    CHECK(!parseTrace(capture.bytes.data(), capture.bytes.size(), records, error), "a trace without the header parsed");
+
+    // Random mixes of writes and reads of different lengths through rings of every size from a lone header up. The
+    // ring must hold the newest records that fit, whole and in order, and account for every one it dropped
+    for (uint16_t size = 7; size <= 96; size++)
+    {
+        struct Operation
+        {
+            bool write;
+            uint8_t len;
+            uint8_t first; // The first data byte
+        };
+        std::vector<Operation> kept;
+        const uint32_t operations = 100;
+        rtc.setTraceBuffer(traceBuffer, size);
+        for (uint32_t operation = 0; operation < operations; operation++)
+        {
+            Operation done;
+            done.write = randomNumber(2);
+            done.len = done.write ? 1 : 1 + randomNumber(8);
+            if (done.write)
+            {
+                done.first = (uint8_t)operation;
+                CHECK(rtc.writeRegister(RV8803_RAM, done.first), "writeRegister failed");
+            }
+            else
+            {
+                uint8_t values[8];
+                CHECK(rtc.readMultipleRegisters(RV8803_RAM, values, done.len), "readMultipleRegisters failed");
+                done.first = values[0];
+            }
+            if (7U + done.len <= size)
+                kept.push_back(done); // Otherwise it is too big for the ring, and only counted as dropped
+        }
+
+        capture.bytes.clear();
+        rtc.exportTrace(capture);
+        bool parsed = parseTrace(capture.bytes.data(), capture.bytes.size(), records, error);
+        CHECK(parsed, "ring of %u: the trace didn't parse: %s", size, error);
+        CHECK(capture.bytes.size() <= 5U + size, "ring of %u: exported %lu bytes", size, (unsigned long)capture.bytes.size());
+        CHECK(records.size() == rtc.getTraceRecordCount(), "ring of %u: %lu records parsed, %u recorded", size, (unsigned long)records.size(),
+              rtc.getTraceRecordCount());
+        CHECK(records.size() + rtc.getTraceDroppedCount() == operations, "ring of %u: %lu records and %lu dropped from %lu", size,
+              (unsigned long)records.size(), (unsigned long)rtc.getTraceDroppedCount(), (unsigned long)operations);
+        CHECK((records.size() <= kept.size()) && (kept.empty() || !records.empty()), "ring of %u: %lu records from %lu that fit", size,
+              (unsigned long)records.size(), (unsigned long)kept.size());
+        if (!parsed || (records.size() > kept.size()))
+            continue;
+        for (size_t index = 0; index < records.size(); index++)
+        {
+            const Operation &expected = kept[kept.size() - records.size() + index];
+            const TraceRecord &record = records[index];
+            CHECK((record.write == expected.write) && (record.addr == RV8803_RAM) && (record.len == expected.len) && (record.data.size() == expected.len)
+                  && (record.data[0] == expected.first), "ring of %u: record %lu isn't the one expected", size, (unsigned long)index);
+            CHECK((index == 0) || ((int32_t)(record.micros - records[index - 1].micros) >= 0), "ring of %u: record %lu went back in time", size,
+                  (unsigned long)index);
+        }
+    }
+
+    // Without a buffer there is only the header
+    rtc.setTraceBuffer(nullptr, 0);
+    rtc.writeRegister(RV8803_RAM, 0);
+    capture.bytes.clear();
+    CHECK((rtc.exportTrace(capture) == 5) && parseTrace(capture.bytes.data(), capture.bytes.size(), records, error) && records.empty(),
+          "tracing didn't stop");
+}
+
+// Runs operation repeatedly and prints the bus traffic and host time per call
+template <typename Operation>
+static void measure(const char* name, Operation operation)
+{
+    const uint32_t calls = 100000;
+    uint32_t transactions = Wire.transactions;
+    uint32_t bytes = Wire.bytes;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < calls; i++)
+    {
+        operation();
+        simAdvanceMicros(1000);
+    }
+    double hostNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+    double callBytes = (double)(Wire.bytes - bytes) / calls;
+    // Each byte is 9 clocks (8 data and the ACK), plus a start and a stop per transaction
+    double callClocks = (callBytes * 9) + (2.0 * (Wire.transactions - transactions) / calls);
+    printf("  %-32s %5.2f transactions %6.2f bytes %8.1f us @ 100 kHz %7.1f us @ 400 kHz %8.0f ns host\n", name,
+           (double)(Wire.transactions - transactions) / calls, callBytes, callClocks * 10.0, callClocks * 2.5, hostNanos);
+}
+
+static void testThroughput()
+{
+    printf("Throughput, per call:\n");
+    uint8_t time[TIME_ARRAY_LENGTH];
+    Wire.setClock(2024, 6, 15, 12, 0, 0, 0);
+    randomTime(time);
+
+    measure("updateTime()", []() { rtc.updateTime(); });
+    rtc.enableTimeValidityTracking(true);
+    measure("updateTime() with validity", []() { rtc.updateTime(); });
+    rtc.enableTimeValidityTracking(false);
+    measure("getEpoch() after updateTime()", []() { rtc.updateTime(); rtc.getEpoch(); });
+    measure("setEpoch()", []() { rtc.setEpoch(1718452800UL, true); });
+    measure("setTime()", [&time]() { rtc.setTime(time, TIME_ARRAY_LENGTH); });
+    measure("setSeconds()", []() { rtc.setSeconds(30); });
+    measure("setTime8601()", []() { rtc.setTime8601("2024-06-15T12:00:00+01:00"); });
+    measure("getMonotonicMillis()", []() { rtc.getMonotonicMillis(); });
+}
+
+int main()
+{
+    const char* seedText = getenv("SOAK_SEED");
+    uint32_t seed = (seedText != nullptr) ? strtoul(seedText, nullptr, 0) : (uint32_t)time(nullptr);
+    if (seed == 0)
+        seed = 1; // xorshift sticks at zero
+
+    if (rtc.begin(Wire) == false)
+    {
+        printf("begin() failed\n");
+        return 1;
+    }
+    rtc.set24Hour();
+
+    testEpochRoundTrip();
+    testRollovers();
+    testTornReads();
+    testTimeUpdates();
+    testRandomSequences(seed);
+    testParse8601();
+    testNMEA();
+    testSnapshot();
+    testNextAlarm();
+    testCountdownTimer();
+    testSlew();
+    testConfig();
+    testBootProfile();
+#ifdef RV8803_HAS_CHRONO
+    testClock();
+#endif
+    testTrace();
+    testContention();
+    testThroughput();
+
+    printf("%lu checks, %lu failed\n", (unsigned long)checks.load(), (unsigned long)failures.load());
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/*
+  Reading back and replaying the bus traces written by RV8803::exportTrace(). See trace.h.
+*/
+
+#include "trace.h"
+#include "SparkFun_RV8803.h"
+
+// As written by RV8803::traceTransaction()
+#define TRACE_HEADER_LENGTH	7
+#define TRACE_WRITE			0x80
+#define TRACE_VERSION		1
+
+bool parseTrace(const uint8_t* trace, size_t length, std::vector<TraceRecord> &records, const char* &error)
+{
+    records.clear();
+    if ((length < 5) || (memcmp(trace, "RV88", 4) != 0))
+    {
+        error = "not a trace (no RV88 header)";
+        return false;
+    }
+    if (trace[4] != TRACE_VERSION)
+    {
+        error = "unknown trace version";
+        return false;
+    }
+
+    size_t index = 5;
+    while (index < length)
+    {
+        if (length - index < TRACE_HEADER_LENGTH)
+        {
+            error = "truncated record header";
+            return false;
+        }
+        TraceRecord record;
+        record.write = (trace[index] & TRACE_WRITE) != 0;
+        record.result = trace[index] & 0x07;
+        record.addr = trace[index + 1];
+        record.len = trace[index + 2];
+        record.micros = 0;
+        for (uint8_t i = 0; i < 4; i++)
+            record.micros |= (uint32_t)trace[index + 3 + i] << (8 * i);
+        index += TRACE_HEADER_LENGTH;
+
+        uint8_t dataLength = (record.write || (record.result == RV8803_SUCCESS)) ? record.len : 0;
+        if (length - index < dataLength)
+        {
+            error = "truncated record data";
+            return false;
+        }
+        record.data.assign(trace + index, trace + index + dataLength);
+        index += dataLength;
+        records.push_back(record);
+    }
+    return true;
+}
+
+// The time registers count, and the flags are set as time passes, so a replay a little out of step reads them
+// differently
+static bool timeDriven(uint8_t reg)
+{
+    return ((reg >= RV8803_HUNDREDTHS) && (reg <= RV8803_YEARS)) || (reg == RV8803_FLAG);
+}
+
+void replayTrace(const std::vector<TraceRecord> &records, TwoWire &sim, ReplayReport &report)
+{
+    report = ReplayReport();
+    sim.reset();
+    uint32_t transactions = sim.transactions;
+    uint32_t bytes = sim.bytes;
+    uint64_t start = simMicros();
+    uint64_t offset = 0;
+
+    for (size_t index = 0; index < records.size(); index++)
+    {
+        const TraceRecord &record = records[index];
+        if (index > 0)
+            offset += (uint32_t)(record.micros - records[index - 1].micros); // micros() wraps every 71 minutes
+        if (simMicros() < start + offset)
+            simAdvanceMicros(start + offset - simMicros());
+
+        report.records++;
+        if (record.result != RV8803_SUCCESS)
+            report.failed++;
+
+        if (record.write)
+        {
+            report.writes++;
+            sim.beginTransmission(RV8803_ADDR);
+            sim.write(record.addr);
+            for (uint8_t value : record.data)
+                sim.write(value);
+            if (record.result != RV8803_SUCCESS)
+                sim.failNext = 1;
+            sim.endTransmission();
+            if (record.result == RV8803_SUCCESS)
+            {
+                for (uint8_t i = 0; i < record.len; i++)
+                    report.known[sim.canonical(record.addr + i)] = true;
+            }
+            continue;
+        }
+
+        report.reads++;
+        bool primed[0x30] = { false };
+        if (record.result == RV8803_SUCCESS)
+        {
+            sim.getClockHundredths(); // Run the clock up to now, so that what we load isn't run on
+            for (uint8_t i = 0; i < record.len; i++)
+            {
+                uint8_t reg = sim.canonical(record.addr + i);
+                if (report.known[reg] == false)
+                {
+                    sim.pokeRegister(reg, record.data[i]);
+                    report.known[reg] = true;
+                    primed[reg] = true;
+                }
+            }
+        }
+
+        sim.beginTransmission(RV8803_ADDR);
+        sim.write(record.addr);
+        bool nack = (record.result != RV8803_SUCCESS) && (record.result != RV8803_ERROR_SHORT_READ);
+        if (nack)
+            sim.failNext = 1;
+        if (sim.endTransmission() != 0)
+            continue; // The library doesn't ask for the data after a NACK
+        if (record.result == RV8803_ERROR_SHORT_READ)
+            sim.failNext = 1;
+        sim.requestFrom(RV8803_ADDR, record.len);
+        if (record.result != RV8803_SUCCESS)
+            continue;
+
+        bool mismatch = false;
+        for (uint8_t i = 0; i < record.len; i++)
+        {
+            uint8_t reg = sim.canonical(record.addr + i);
+            int value = sim.read();
+            if (primed[reg] || (value == record.data[i]))
+                continue;
+            if (timeDriven(reg))
+                report.timeMismatches++;
+            else
+            {
+                report.registerMismatches++;
+                mismatch = true;
+            }
+        }
+        if (mismatch && (report.firstMismatch < 0))
+            report.firstMismatch = index;
+    }
+
+    report.transactions = sim.transactions - transactions;
+    report.bytes = sim.bytes - bytes;
+    report.spanMicros = offset;
+    sim.getClockHundredths();
+    for (uint8_t reg = 0; reg < sizeof(report.registers); reg++)
+        report.registers[reg] = sim.peekRegister(reg);
+}
@@ -0,0 +1,47 @@
+/*
+  Reading back the bus traces written by RV8803::exportTrace(), and replaying them against the simulated RV-8803 in
+  mock/. Used by replay.cpp, and by the soak test to check the recorder.
+*/
+
+#ifndef RV8803_TRACE_H
+#define RV8803_TRACE_H
+
+#include "Wire.h"
+
+#include <vector>
+
+struct TraceRecord
+{
+	bool write;
+	uint8_t result; //RV8803_Result
+	uint8_t addr;
+	uint8_t len;
+	uint32_t micros; //micros() when the transaction finished
+	std::vector<uint8_t> data; //Empty for a read that failed
+};
+
+struct ReplayReport
+{
+	uint32_t records = 0;
+	uint32_t reads = 0;
+	uint32_t writes = 0;
+	uint32_t failed = 0;
+	uint32_t transactions = 0; //On the simulated bus, counted like TwoWire::transactions
+	uint32_t bytes = 0; //On the simulated bus, address bytes included
+	uint64_t spanMicros = 0; //From the first record to the last
+	uint32_t registerMismatches = 0; //Bytes read from configuration registers which differ from the simulator
+	uint32_t timeMismatches = 0; //The same for the time and flag registers, which a hundredth or so of drift explains
+	int32_t firstMismatch = -1; //Index of the first record with a configuration register mismatch
+	uint8_t registers[0x30] = { 0 }; //What the simulator held at the end
+	bool known[0x30] = { false }; //Registers the trace wrote or read, so registers[] can be believed
+};
+
+//Splits an exportTrace() image into records. False with error set if it is malformed
+bool parseTrace(const uint8_t * trace, size_t length, std::vector<TraceRecord> &records, const char * &error);
+
+//Replays the records on sim, at their recorded spacing in time and with their recorded failures. A register is
+//loaded into the simulator with the value it was first read with, unless the trace wrote it first; after that
+//every read is checked against the simulator
+void replayTrace(const std::vector<TraceRecord> &records, TwoWire &sim, ReplayReport &report);
+
+#endif